@@ -4,6 +4,8 @@
 
 #include "io430f5529.h"
 #include "adc12.h"
+#include "power.h"
+#include "trace.h"
 
 
 /**
@@ -55,9 +57,16 @@ void initADC12 (void)
  */ 
 int adc12GetRaw(void)
 {
+    // The end of the conversion 
+    // wakes the CPU
+    ADC12IE |= ADC12IE0;
+    powerRequire(POWER_ADC12, POWER_LPM3);
+    
     // Start conversion
     ADC12_START_CONVERSION();
-    ADC12_WAIT_CONVERSION();
+    
+    while (IS_ADC12_BUSY())
+        powerIdle();
     
     return ADC12MEM0;
 }
@@ -78,6 +87,11 @@ bool adc12GetRawAsync(unsigned int* result)
     
     if (!_isConverting)
     {
+        // The end of the conversion 
+        // wakes the CPU
+        ADC12IE |= ADC12IE0;
+        powerRequire(POWER_ADC12, POWER_LPM3);
+        
         ADC12_START_CONVERSION();
         _isConverting = true;
     }
@@ -91,4 +105,21 @@ bool adc12GetRawAsync(unsigned int* result)
 }
 
 
+#pragma vector = ADC12_VECTOR
+__interrupt void __adc12_interrupt(void)
+{
+    TRACE_ISR_ENTER(TRACE_ADC12);
+    
+    // ADC12MEM0 is left to adc12GetRawAsync,
+    // reading it would clear the flag
+    ADC12IE &= ~ADC12IE0;
+    powerRelease(POWER_ADC12);
+    
+    POWER_POST_WORK();
+    
+    TRACE_ISR_EXIT(TRACE_ADC12);
+    POWER_WAKE_ON_EXIT();
+}
+
+
 #endif // !ADC12_TEMPERATURE_C
\ No newline at end of file
@@ -56,6 +56,8 @@ int adc12GetRaw(void);
  * Begins the conversion and returns 
  * true when the value is ready, false 
  * otherwise.
+ * The end of the conversion wakes the CPU 
+ * from a low power mode.
  *
  * @param result 
  *      A pointer to an integer that will hold 
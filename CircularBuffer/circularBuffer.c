@@ -7,7 +7,6 @@
 
 
 //--------------------------------------------------------------------------------------
-#include <stdlib.h>
 #include "circularBuffer.h"
 
 /* Circular buffer */
@@ -20,15 +19,22 @@
 //} CircularBuffer;
 
 /** 
- * Inizialize circular buffer 
+ * Inizialize circular buffer, the elements come from
+ * a pool if small enough (freed by cbFree), from the
+ * arena otherwise. Returns false if out of memory
  */
-void cbInit(CircularBuffer *cb, uint size) 
+bool cbInit(CircularBuffer *cb, uint size) 
 {             
     cb->size  = size;
     cb->w_pos = 0;
     cb->r_pos = 0;
     cb->count = 0;
-    cb->buff  = (byte*)malloc(cb->size * sizeof(byte));
+    cb->buff  = (byte*)memAllocAny(size * sizeof(byte));
+
+    if (cb->buff == NULL)
+        cb->size = 0;
+
+    return cb->buff != NULL;
 }
 
 
@@ -37,7 +43,10 @@ void cbInit(CircularBuffer *cb, uint size)
  */
 inline void cbFree(CircularBuffer *cb)
 {                       
-    free(cb->buff); /* OK if null */
+    memFree(cb->buff); /* OK if null */
+    cb->buff = NULL;
+    cb->size = 0;
+    cb->count = 0;
 }
 
 
@@ -99,5 +108,34 @@ bool cbRead(CircularBuffer *cb, byte *elem)
 
     return true; 
 }
+
+
+/** 
+ * Get the contiguous free space after the write index,
+ * returns its size 
+ */
+uint cbWriteSpace(CircularBuffer *cb, byte **start)
+{
+    uint free = cb->size - cb->count;
+    uint tail = cb->size - cb->w_pos;
+
+    *start = cb->buff + cb->w_pos;
+
+    return free < tail ? free : tail;
+}
+
+
+/** 
+ * Add the bytes written in place after
+ * cbWriteSpace to the buffer 
+ */
+void cbWriteCommit(CircularBuffer *cb, uint length)
+{
+    cb->w_pos += length;
+    if (cb->w_pos >= cb->size)
+        cb->w_pos -= cb->size;
+
+    cb->count += length;
+}
 //------------------------------------------------------------------------------------
 
@@ -9,6 +9,7 @@
 #define CIRCULAR_BUFFER_H_
 
 #include "utility.h"
+#include "memoryManager.h"
 
 /** 
  * Circular buffer struct 
@@ -24,8 +25,15 @@ typedef struct {
 void cbFree   (CircularBuffer *cb);
 int  cbIsFull (CircularBuffer *cb);
 int  cbIsEmpty(CircularBuffer *cb);
-void cbInit   (CircularBuffer *cb, uint  size);
+bool cbInit   (CircularBuffer *cb, uint  size);
 bool cbWrite  (CircularBuffer *cb, byte  elem);
 bool cbRead   (CircularBuffer *cb, byte *elem);
 
+/** 
+ * Contiguous free space, to write in place 
+ * (e.g. with the DMA) and then commit 
+ */
+uint cbWriteSpace (CircularBuffer *cb, byte **start);
+void cbWriteCommit(CircularBuffer *cb, uint  length);
+
 #endif /* CIRCULAR_BUFFER_H_ */
@@ -0,0 +1,98 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief
+ * The CRC16-CCITT of the CRC module: polynomial 0x1021,
+ * not reflected, initial value 0xFFFF, no final xor
+ * (also known as CRC-16/CCITT-FALSE).
+ *
+ * The CRC module holds a single computation: the
+ * functions are for the main loop only, or must
+ * be called with the interrupts disabled.
+ */
+
+
+#ifndef CRC16_HARDWARE
+/**
+ * @brief Computes with the CRC module: with 0
+ * every function uses the table (the host build).
+ */
+#define CRC16_HARDWARE 1
+#endif // !CRC16_HARDWARE
+
+
+#ifndef CRC16_DMA_CHANNEL
+/**
+ * @brief
+ * The channel of crc16UpdateDma. It's borrowed only
+ * while idle, checked and programmed with the
+ * interrupts disabled, and its trigger is changed:
+ * the I2C one (shared by default) selects its trigger
+ * at each transfer, the SPI ones don't (spi.h).
+ */
+#define CRC16_DMA_CHANNEL 0
+#endif // !CRC16_DMA_CHANNEL
+
+
+#ifndef CRC16_DMA_THRESHOLD
+/**
+ * @brief The shorter blocks are fed by the CPU:
+ * setting up the DMA would take longer.
+ */
+#define CRC16_DMA_THRESHOLD 32
+#endif // !CRC16_DMA_THRESHOLD
+
+
+/**
+ * @brief The initial value of a CRC.
+ */
+#define CRC16_INIT 0xFFFF
+
+
+/**
+ * @brief The CRC of "123456789".
+ */
+#define CRC16_CHECK 0x29B1
+
+
+/**
+ * @brief
+ * The CRC of a block.
+ */
+uint crc16(const byte* data, uint length);
+
+
+/**
+ * @brief
+ * Adds a block to a CRC, from CRC16_INIT: the
+ * blocks of a message can be added one at a time.
+ * The CPU feeds the CRC module.
+ */
+uint crc16Update(uint crc, const byte* data, uint length);
+
+
+/**
+ * @brief
+ * Adds a block to a CRC: the DMA feeds the CRC module
+ * with a block transfer, which halts the CPU until
+ * it's over: the interrupts wait for it. Fed by the
+ * CPU if the block is short or the channel is busy.
+ */
+uint crc16UpdateDma(uint crc, const byte* data, uint length);
+
+
+/**
+ * @brief
+ * Adds a block to a CRC from a table, without the
+ * CRC module: the same results, for the host build
+ * and to check the module.
+ */
+uint crc16Software(uint crc, const byte* data, uint length);
+
+
+#endif // !CRC16_H
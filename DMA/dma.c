@@ -0,0 +1,54 @@
+#ifndef DMA_C
+#define DMA_C
+
+#include "dma.h"
+#include "power.h"
+#include "trace.h"
+
+
+/**
+ * @brief The callbacks of the channels,
+ * they share the DMA interrupt.
+ */
+static Action _completed[DMA_CHANNELS] = { NULL, NULL, NULL };
+
+
+void dmaSetTrigger(byte channel, DmaTrigger trigger)
+{
+    // Channels 0 and 1 share DMACTL0,
+    // channel 2 uses DMACTL1
+    switch (channel)
+    {
+        case 0: DMACTL0 = (DMACTL0 & 0xFF00) | trigger;        break;
+        case 1: DMACTL0 = (DMACTL0 & 0x00FF) | (trigger << 8); break;
+        case 2: DMACTL1 = (DMACTL1 & 0xFF00) | trigger;        break;
+    }
+}
+
+
+void dmaSetCallback(byte channel, Action completed)
+{
+    if (channel < DMA_CHANNELS)
+        _completed[channel] = completed;
+}
+
+
+#pragma vector = DMA_VECTOR
+__interrupt void __dma_interrupt(void)
+{
+    TRACE_ISR_ENTER(TRACE_DMA);
+    
+    // Reading DMAIV clears the flag
+    switch (__even_in_range(DMAIV, DMAIV_DMA2IFG))
+    {
+        case DMAIV_DMA0IFG: RAISE_EVENT(_completed[0]); break;
+        case DMAIV_DMA1IFG: RAISE_EVENT(_completed[1]); break;
+        case DMAIV_DMA2IFG: RAISE_EVENT(_completed[2]); break;
+    }
+    
+    TRACE_ISR_EXIT(TRACE_DMA);
+    POWER_WAKE_ON_EXIT();
+}
+
+
+#endif // !DMA_C
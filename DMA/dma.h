@@ -0,0 +1,97 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief The number of DMA channels.
+ */
+#define DMA_CHANNELS 3
+
+
+/**
+ * @brief The DMA trigger sources (DMAxTSEL)
+ * used by the library.
+ */
+typedef enum DmaTrigger
+{
+    DMA_TRIGGER_DMAREQ   = 0,
+    DMA_TRIGGER_UCB0_RX  = 18,
+    DMA_TRIGGER_UCB0_TX  = 19,
+    DMA_TRIGGER_UCB1_RX  = 22,
+    DMA_TRIGGER_UCB1_TX  = 23
+} DmaTrigger;
+
+
+/**
+ * @brief Returns the given register (CTL, SA, DA, SZ)
+ * of a channel, which must be a constant.
+ */
+#define DMA_REGISTER(channel, reg)  _DMA_REGISTER(channel, reg)
+#define _DMA_REGISTER(channel, reg) DMA##channel##reg
+
+
+#ifndef DMA_WRITE_ADDRESS
+/**
+ * @brief Writes a 20 bits address to 
+ * a DMAxSA or DMAxDA register.
+ */
+#define DMA_WRITE_ADDRESS(reg, address) \
+    __data16_write_addr((unsigned short)&(reg), (unsigned long)(address))
+#endif // !DMA_WRITE_ADDRESS
+
+
+/**
+ * @brief Transfers the given number of bytes,
+ * one per trigger (single transfer mode), and 
+ * then raises the channel's callback.
+ * 
+ * The channel must be a constant.
+ *
+ * @param ctl 
+ *      The address increments (DMASRCINCR_x, DMADSTINCR_x)
+ *      and any other DMAxCTL flag.
+ */
+#define DMA_START(channel, source, destination, size, ctl)          \
+    {                                                               \
+        DMA_REGISTER(channel, CTL) = 0;                             \
+        DMA_WRITE_ADDRESS(DMA_REGISTER(channel, SA), (source));     \
+        DMA_WRITE_ADDRESS(DMA_REGISTER(channel, DA), (destination));\
+        DMA_REGISTER(channel, SZ)  = (size);                        \
+        DMA_REGISTER(channel, CTL) =                                \
+            DMASRCBYTE + DMADSTBYTE + DMAIE + DMAEN + (ctl);        \
+    }
+
+
+/**
+ * @brief Stops a channel's transfer.
+ */
+#define DMA_STOP(channel) \
+    (DMA_REGISTER(channel, CTL) &= ~(DMAEN + DMAIE))
+
+
+/**
+ * @brief Tells whether a channel's 
+ * transfer is running.
+ */
+#define DMA_IS_BUSY(channel) \
+    (DMA_REGISTER(channel, CTL) & DMAEN)
+
+
+/**
+ * @brief Selects the trigger of a channel.
+ */
+void dmaSetTrigger(byte channel, DmaTrigger trigger);
+
+
+/**
+ * @brief Sets the callback raised from the DMA 
+ * interrupt when a channel's transfer is over.
+ * Can be NULL.
+ */
+void dmaSetCallback(byte channel, Action completed);
+
+
+#endif // !DMA_H
@@ -1,5 +1,6 @@
 #include "debouncer.h"
 #include "utility.h"
+#include "memoryManager.h"
 #include <stdlib.h>
 
 
@@ -17,7 +18,9 @@ Button* createButton(
   ButtonState initialState
 ) {
   Button* result = 
-    (Button*)malloc(sizeof(Button));
+    (Button*)memAlloc(sizeof(Button));
+  
+  if (result == NULL) return NULL;
   
   result->buttonIn = buttonIn;
   result->buttonPort = buttonPort;
@@ -55,12 +58,12 @@ static void _updateState(Button *button) {
   ButtonState *state = &(button->_state);
 
   if (allHigh(readings)) {
-    *state = *state != RELEASED
+    *state = *state != RELEASED && *state != JUST_RELEASED
       ? JUST_RELEASED
       : RELEASED;
   }
   else if (allLow(readings)) {
-    *state = *state != PRESSED
+    *state = *state != PRESSED && *state != JUST_PRESSED
       ? JUST_PRESSED
       : PRESSED;
   }
@@ -71,4 +74,56 @@ static void _raiseEvents(Button *button) {
     case JUST_PRESSED:  RAISE_EVENT(button->buttonPressed);  break;
     case JUST_RELEASED: RAISE_EVENT(button->buttonReleased); break;
   }
-}
\ No newline at end of file
+}
+
+
+PortDebouncer* createPortDebouncer(
+  Register* portIn,
+  BitVector8b mask,
+  BitVector8b initialState
+) {
+  PortDebouncer* result = 
+    (PortDebouncer*)memAlloc(sizeof(PortDebouncer));
+  
+  if (result == NULL) return NULL;
+  
+  result->portIn = portIn;
+  result->mask = mask;
+  
+  result->state = initialState;
+  result->pressed = 0;
+  result->released = 0;
+  
+  result->_count0 = 0;
+  result->_count1 = 0;
+  
+  return result;
+}
+
+
+BitVector8b readPortDebounce(PortDebouncer* port) {
+  return updatePortDebounce(port, *(port->portIn));
+}
+
+
+BitVector8b updatePortDebounce(PortDebouncer* port, BitVector8b sample) {
+  // Pins that differ from the debounced state,
+  // the counters of the others are reset
+  const BitVector8b delta = 
+    (sample ^ port->state) & port->mask;
+  
+  port->_count1 = (port->_count1 ^ port->_count0) & delta;
+  port->_count0 = ~(port->_count0) & delta;
+  
+  // A counter that wraps to zero while its pin still
+  // differs has seen 4 samples in a row: toggling it
+  const BitVector8b toggled = 
+    delta & ~(port->_count0 | port->_count1);
+  
+  port->state ^= toggled;
+  
+  port->pressed  = toggled & ~(port->state);
+  port->released = toggled &   port->state;
+  
+  return toggled;
+}
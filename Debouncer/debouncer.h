@@ -27,6 +27,28 @@ typedef struct Button
 } Button;
 
 
+/**
+ * Debounces all the pins of a port at once,
+ * using 2-bit vertical counters: bit n of 
+ * _count0 and _count1 form the counter of pin n.
+ *
+ * A pin changes its debounced state after 
+ * 4 consecutive samples that differ from it.
+ */
+typedef struct PortDebouncer
+{
+  Register* portIn;
+  BitVector8b mask;
+  
+  BitVector8b state;
+  BitVector8b pressed;
+  BitVector8b released;
+  
+  BitVector8b _count0;
+  BitVector8b _count1;
+} PortDebouncer;
+
+
 /**
  * Initializes a DebounceSettings struct.
  *
@@ -54,7 +76,8 @@ typedef struct Button
  *      initial state should be raised or not.
  *
  * @returns
- *      A pointer to the newly allocated struct.
+ *      A pointer to the newly allocated struct,
+ *      NULL if out of memory.
  */
 Button* createButton(
   Register* buttonInRegister,
@@ -76,4 +99,63 @@ Button* createButton(
  */
 ButtonState readDebounce(Button* debounceInfo);
 
+
+/**
+ * Initializes a PortDebouncer struct.
+ *
+ * @param portIn
+ *      The port's IN register (PxIN) address.
+ *
+ * @param mask
+ *      The pins (BITx) to debounce, the others
+ *      are always reported as stable.
+ *
+ * @param initialState
+ *      The initial debounced state of the pins,
+ *      usually the current value of PxIN.
+ *
+ * @returns
+ *      A pointer to the newly allocated struct,
+ *      NULL if out of memory.
+ */
+PortDebouncer* createPortDebouncer(
+  Register* portIn,
+  BitVector8b mask,
+  BitVector8b initialState
+);
+
+
+/**
+ * Samples the port once and advances the vertical
+ * counters of all its pins. 
+ * Buttons are active low, like in readDebounce.
+ *
+ * The edges of this sample are stored in the
+ * pressed and released fields of the struct.
+ *
+ * @returns 
+ *      A mask of the pins that changed state,
+ *      pressed | released.
+ */
+BitVector8b readPortDebounce(PortDebouncer* port);
+
+
+/**
+ * Advances the vertical counters with an already
+ * read sample, so that more ports can be read 
+ * at the same time or in an interrupt.
+ *
+ * @returns 
+ *      A mask of the pins that changed state.
+ */
+BitVector8b updatePortDebounce(PortDebouncer* port, BitVector8b sample);
+
+
+/**
+ * Tells whether the port's pins are not bouncing,
+ * i.e. all the counters are at zero.
+ */
+#define IS_PORT_STABLE(port) \
+  (((port)->_count0 | (port)->_count1) == 0)
+
 #endif
\ No newline at end of file
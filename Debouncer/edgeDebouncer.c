@@ -0,0 +1,220 @@
+#include "edgeDebouncer.h"
+#include "power.h"
+#include "trace.h"
+
+
+/**
+ * The debouncers of P1 and P2, NULL 
+ * when the port is not used.
+ */
+static EdgeDebouncer  _debouncers[2];
+static EdgeDebouncer* _active[2] = { NULL, NULL };
+
+
+static void _arm(EdgeDebouncer *edge);
+static void _startSampling(EdgeDebouncer *edge);
+static void _onEdge(EdgeDebouncer *edge);
+
+
+EdgeDebouncer* initEdgeDebounce(
+  byte port,
+  BitVector8b mask,
+  PortAction changed
+) {
+  EdgeDebouncer* edge;
+  Register* portIn;
+  
+  switch (port) {
+    case 1:
+      edge = &_debouncers[0];
+      portIn = &P1IN;
+      edge->portIes = &P1IES;
+      edge->portIe  = &P1IE;
+      edge->portIfg = &P1IFG;
+      break;
+      
+    case 2:
+      edge = &_debouncers[1];
+      portIn = &P2IN;
+      edge->portIes = &P2IES;
+      edge->portIe  = &P2IE;
+      edge->portIfg = &P2IFG;
+      break;
+      
+    default:
+      return NULL;
+  }
+  
+  *(edge->portIe) &= ~mask;
+  
+  edge->debouncer.portIn = portIn;
+  edge->debouncer.mask = mask;
+  edge->debouncer.state = *portIn;
+  edge->debouncer.pressed = 0;
+  edge->debouncer.released = 0;
+  edge->debouncer._count0 = 0;
+  edge->debouncer._count1 = 0;
+  
+  edge->changed = changed;
+  edge->_idleSamples = 0;
+  edge->_sampling = false;
+  
+  _active[port - 1] = edge;
+  _arm(edge);
+  
+  return edge;
+}
+
+
+void stopEdgeDebounce(byte port) {
+  if (port < 1 || port > 2 || _active[port - 1] == NULL) 
+    return;
+  
+  EdgeDebouncer* edge = _active[port - 1];
+  
+  *(edge->portIe) &= ~(edge->debouncer.mask);
+  edge->_sampling = false;
+  _active[port - 1] = NULL;
+}
+
+
+bool isEdgeDebouncing(void) {
+  return TB0CTL & MC_1;
+}
+
+
+/**
+ * Sets the edge of each pin opposite to its 
+ * debounced state and enables the interrupts.
+ */
+static void _arm(EdgeDebouncer *edge) {
+  const BitVector8b mask  = edge->debouncer.mask;
+  const BitVector8b state = edge->debouncer.state;
+  
+  // High pins wait for a high-to-low edge (IES = 1),
+  // low pins for a low-to-high one (IES = 0)
+  *(edge->portIes) = (*(edge->portIes) & ~mask) | (state & mask);
+  
+  // Changing PxIES can set PxIFG
+  *(edge->portIfg) &= ~mask;
+  *(edge->portIe)  |=  mask;
+  
+  // A pin that moved while arming would
+  // never raise its edge: raising it by hand
+  const BitVector8b moved = 
+    (*(edge->debouncer.portIn) ^ state) & mask;
+  
+  if (moved)
+    *(edge->portIfg) |= moved;
+}
+
+
+static void _startSampling(EdgeDebouncer *edge) {
+  edge->_idleSamples = 0;
+  edge->_sampling = true;
+  
+  if (TB0CTL & MC_1)
+    return;
+  
+  // From a port interrupt: 
+  // wakes the CPU from LPM4
+  powerRequire(POWER_DEBOUNCER, POWER_LPM3);
+  
+  TB0CCR0  = EDGE_DEBOUNCE_PERIOD;
+  TB0CCTL0 = CCIE;
+  TB0CTL   = 
+    TBSSEL_1 + // ACLK, available down to LPM3
+    MC_1     + // Count mode up
+    TBCLR;
+}
+
+
+static void _onEdge(EdgeDebouncer *edge) {
+  const BitVector8b mask = edge->debouncer.mask;
+  
+  if (!(*(edge->portIfg) & *(edge->portIe) & mask))
+    return;
+  
+  // The whole port is sampled until it's 
+  // stable again, so no more edges are needed
+  *(edge->portIe)  &= ~mask;
+  *(edge->portIfg) &= ~mask;
+  
+  _startSampling(edge);
+}
+
+
+#pragma vector = PORT1_VECTOR
+__interrupt void __port1_edge_interrupt(void)
+{
+  TRACE_ISR_ENTER(TRACE_PORT_EDGE);
+  
+  if (_active[0] != NULL)
+    _onEdge(_active[0]);
+  
+  TRACE_ISR_EXIT(TRACE_PORT_EDGE);
+  POWER_WAKE_ON_EXIT();
+}
+
+
+#pragma vector = PORT2_VECTOR
+__interrupt void __port2_edge_interrupt(void)
+{
+  TRACE_ISR_ENTER(TRACE_PORT_EDGE);
+  
+  if (_active[1] != NULL)
+    _onEdge(_active[1]);
+  
+  TRACE_ISR_EXIT(TRACE_PORT_EDGE);
+  POWER_WAKE_ON_EXIT();
+}
+
+
+/**
+ * Samples the bouncing ports, raises their
+ * events and stops once all of them are 
+ * stable again.
+ */
+#pragma vector = TIMER0_B0_VECTOR
+__interrupt void __edge_debounce_interrupt(void)
+{
+  register byte i;
+  bool sampling = false;
+  
+  TRACE_ISR_ENTER(TRACE_DEBOUNCER);
+  
+  for (i = 0; i < 2; i++) {
+    EdgeDebouncer* edge = _active[i];
+    
+    if (edge == NULL || !edge->_sampling)
+      continue;
+    
+    PortDebouncer* port = &(edge->debouncer);
+    
+    if (readPortDebounce(port) && edge->changed != NULL)
+      edge->changed(port->pressed, port->released);
+    
+    if (!IS_PORT_STABLE(port))
+      edge->_idleSamples = 0;
+    
+    else if (++(edge->_idleSamples) >= EDGE_DEBOUNCE_IDLE_SAMPLES) {
+      edge->_sampling = false;
+      _arm(edge);
+      continue;
+    }
+    
+    sampling = true;
+  }
+  
+  // Nothing left to sample: stopping the timer
+  if (!sampling) {
+    TB0CCTL0 &= ~CCIE;
+    TB0CTL   &= ~MC_3;
+    powerRelease(POWER_DEBOUNCER);
+  }
+  
+  TRACE_ISR_EXIT(TRACE_DEBOUNCER);
+  
+  // The callbacks can post work
+  POWER_WAKE_ON_EXIT();
+}
@@ -0,0 +1,102 @@
+#ifndef EDGE_DEBOUNCER_H
+#define EDGE_DEBOUNCER_H
+
+#include "io430f5529.h"
+#include "utility.h"
+#include "debouncer.h"
+
+
+#ifndef EDGE_DEBOUNCE_PERIOD
+/**
+ * The TB0 ccr0 value between two samples 
+ * of a bouncing port. TB0 runs from ACLK 
+ * (32768 Hz), so 33 is about a millisecond.
+ */
+#define EDGE_DEBOUNCE_PERIOD 33
+#endif // !EDGE_DEBOUNCE_PERIOD
+
+
+#ifndef EDGE_DEBOUNCE_IDLE_SAMPLES
+/**
+ * The number of stable samples after which 
+ * a port stops being sampled and its edge 
+ * interrupts are armed again.
+ */
+#define EDGE_DEBOUNCE_IDLE_SAMPLES 4
+#endif // !EDGE_DEBOUNCE_IDLE_SAMPLES
+
+
+/**
+ * A callback that receives the pins of a 
+ * port that were just pressed and released.
+ */
+typedef void (*PortAction)(BitVector8b pressed, BitVector8b released);
+
+
+/**
+ * Debounces the pins of P1 or P2 only when 
+ * they move: the port's edge interrupts start
+ * the sampling timer (TB0), which is stopped 
+ * again as soon as every port is stable.
+ * 
+ * While no pin is bouncing no code runs at all,
+ * so the CPU can stay in LPM3/LPM4.
+ *
+ * Uses the PORT1, PORT2 and TIMER0_B0 vectors.
+ */
+typedef struct EdgeDebouncer
+{
+  PortDebouncer debouncer;
+  
+  Register* portIes;
+  Register* portIe;
+  Register* portIfg;
+  
+  PortAction changed;
+  
+  byte _idleSamples;
+  bool _sampling;
+} EdgeDebouncer;
+
+
+/**
+ * Initializes the edge debouncer of a port and
+ * arms its edge interrupts.
+ * The pins must already be configured as inputs
+ * (PxDIR, PxREN, PxOUT).
+ *
+ * @param port
+ *      The port number, either 1 or 2 
+ *      (the only ones with edge interrupts).
+ *
+ * @param mask
+ *      The pins (BITx) to debounce.
+ *
+ * @param changed
+ *      A callback invoked from the sampling 
+ *      interrupt when some pins change state. 
+ *      Can be NULL.
+ *
+ * @returns
+ *      The port's debouncer, or NULL if the 
+ *      port has no edge interrupts.
+ */
+EdgeDebouncer* initEdgeDebounce(
+  byte port,
+  BitVector8b mask,
+  PortAction changed
+);
+
+
+/**
+ * Disarms the edge interrupts of a port.
+ */
+void stopEdgeDebounce(byte port);
+
+
+/**
+ * Tells whether any port is being sampled.
+ */
+bool isEdgeDebouncing(void);
+
+#endif // !EDGE_DEBOUNCER_H
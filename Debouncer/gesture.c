@@ -0,0 +1,121 @@
+#include "gesture.h"
+#include "utility.h"
+#include "memoryManager.h"
+
+
+typedef enum GestureState {
+  G_IDLE = 0x00,
+  G_DOWN,
+  G_UP,
+  G_DOWN_AGAIN,
+  G_HELD,
+  G_STATES
+} GestureState;
+
+
+typedef enum GestureInput {
+  G_PRESS = 0x00,
+  G_RELEASE,
+  G_TIMEOUT,
+  G_INPUTS
+} GestureInput;
+
+
+typedef enum GestureTimer {
+  T_KEEP = 0x00,
+  T_STOP,
+  T_LONG_PRESS,
+  T_DOUBLE_CLICK,
+  T_REPEAT
+} GestureTimer;
+
+
+typedef struct GestureTransition {
+  byte next;
+  byte event;
+  byte timer;
+} GestureTransition;
+
+
+/**
+ * The state machine of every button:
+ * [state][input] -> next state, event, timer.
+ */
+static const GestureTransition _transitions[G_STATES][G_INPUTS] = {
+  /*                 G_PRESS                              G_RELEASE                                G_TIMEOUT                                  */
+  /* G_IDLE       */ { { G_DOWN,       GESTURE_NONE, T_LONG_PRESS }, { G_IDLE, GESTURE_NONE,         T_STOP         }, { G_IDLE,       GESTURE_NONE,       T_STOP   } },
+  /* G_DOWN       */ { { G_DOWN,       GESTURE_NONE, T_KEEP       }, { G_UP,   GESTURE_NONE,         T_DOUBLE_CLICK }, { G_HELD,       GESTURE_LONG_PRESS, T_REPEAT } },
+  /* G_UP         */ { { G_DOWN_AGAIN, GESTURE_NONE, T_STOP       }, { G_UP,   GESTURE_NONE,         T_KEEP         }, { G_IDLE,       GESTURE_CLICK,      T_STOP   } },
+  /* G_DOWN_AGAIN */ { { G_DOWN_AGAIN, GESTURE_NONE, T_KEEP       }, { G_IDLE, GESTURE_DOUBLE_CLICK, T_STOP         }, { G_DOWN_AGAIN, GESTURE_NONE,       T_STOP   } },
+  /* G_HELD       */ { { G_HELD,       GESTURE_NONE, T_KEEP       }, { G_IDLE, GESTURE_NONE,         T_STOP         }, { G_HELD,       GESTURE_REPEAT,     T_REPEAT } },
+};
+
+
+static void _advance(GestureButton *gesture, GestureInput input);
+
+
+GestureButton* createGestureButton(
+  Button* button,
+  const GestureTimings* timings,
+  GestureAction gesture
+) {
+  GestureButton* result = 
+    (GestureButton*)memAlloc(sizeof(GestureButton));
+  
+  if (result == NULL) return NULL;
+  
+  result->button = button;
+  result->timings = timings;
+  result->gesture = gesture;
+  
+  result->_state = G_IDLE;
+  result->_ticks = 0;
+  
+  return result;
+}
+
+
+void scanGestures(GestureButton** buttons, byte count) {
+  register byte i;
+  
+  for (i = 0; i < count; i++) {
+    GestureButton* gesture = buttons[i];
+    
+    // Counted before the edges: a timer they load
+    // starts counting at the next scan.
+    // A stopped timer stays at 0
+    if (gesture->_ticks != 0 && --(gesture->_ticks) == 0)
+      _advance(gesture, G_TIMEOUT);
+    
+    switch (readDebounce(gesture->button)) {
+      case JUST_PRESSED:  _advance(gesture, G_PRESS);   break;
+      case JUST_RELEASED: _advance(gesture, G_RELEASE); break;
+      default:                                          break;
+    }
+  }
+}
+
+
+static void _advance(GestureButton *gesture, GestureInput input) {
+  const GestureTimings* timings = gesture->timings;
+  const GestureTransition* transition = 
+    &_transitions[gesture->_state][input];
+  
+  gesture->_state = transition->next;
+  
+  switch (transition->timer) {
+    case T_STOP:         gesture->_ticks = 0;                         break;
+    case T_LONG_PRESS:   gesture->_ticks = timings->longPressTicks;   break;
+    case T_DOUBLE_CLICK: gesture->_ticks = timings->doubleClickTicks; break;
+    case T_REPEAT:       gesture->_ticks = timings->repeatTicks;      break;
+    default:                                                          break;
+  }
+  
+  if (transition->event != GESTURE_NONE && gesture->gesture != NULL)
+    gesture->gesture(gesture, (GestureEvent)transition->event);
+  
+  // Without a double click window the click 
+  // is reported as soon as the button is released
+  if (transition->timer == T_DOUBLE_CLICK && gesture->_ticks == 0)
+    _advance(gesture, G_TIMEOUT);
+}
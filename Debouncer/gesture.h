@@ -0,0 +1,105 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include "utility.h"
+#include "debouncer.h"
+
+
+typedef enum GestureEvent {
+  GESTURE_NONE = 0x00,
+  GESTURE_CLICK,
+  GESTURE_DOUBLE_CLICK,
+  GESTURE_LONG_PRESS,
+  GESTURE_REPEAT,
+} GestureEvent;
+
+
+/**
+ * The durations of the gestures, in calls 
+ * to scanGestures (ticks). 
+ * Can be shared by many buttons.
+ */
+typedef struct GestureTimings
+{
+  /**
+   * How long to wait after a click for the 
+   * second one. 0 reports clicks right away.
+   */
+  uint doubleClickTicks;
+  
+  /**
+   * How long the button must be held before
+   * a GESTURE_LONG_PRESS. 0 disables it.
+   */
+  uint longPressTicks;
+  
+  /**
+   * The interval of the GESTURE_REPEAT events 
+   * while the button is held after a long press.
+   * 0 disables the repeat.
+   */
+  uint repeatTicks;
+} GestureTimings;
+
+
+struct GestureButton;
+
+typedef void (*GestureAction)(struct GestureButton* button, GestureEvent event);
+
+
+/**
+ * A Button with a state machine that reports
+ * clicks, double clicks, long presses and the
+ * auto-repeat while held.
+ */
+typedef struct GestureButton
+{
+  Button* button;
+  const GestureTimings* timings;
+  GestureAction gesture;
+  
+  byte _state;
+  uint _ticks;
+} GestureButton;
+
+
+/**
+ * Initializes a GestureButton struct.
+ *
+ * @param button
+ *      The debounced button, read by scanGestures.
+ *      Its own callbacks keep working.
+ *
+ * @param timings
+ *      The gestures' durations.
+ *
+ * @param gesture
+ *      A pointer to a callback function for the 
+ *      recognized gestures. Can be NULL.
+ *
+ * @returns
+ *      A pointer to the newly allocated struct,
+ *      NULL if out of memory.
+ */
+GestureButton* createGestureButton(
+  Button* button,
+  const GestureTimings* timings,
+  GestureAction gesture
+);
+
+
+/**
+ * Debounces a set of buttons and advances their 
+ * gestures by one tick. 
+ * Meant to be called by a single periodic timer
+ * for all the buttons.
+ *
+ * @param buttons
+ *      The buttons to scan.
+ *
+ * @param count
+ *      The number of buttons.
+ */
+void scanGestures(GestureButton** buttons, byte count);
+
+#endif // !GESTURE_H
@@ -0,0 +1,552 @@
+#ifndef FLASH_STORE_C
+#define FLASH_STORE_C
+
+#include "flashStore.h"
+#include "crc16.h"
+
+
+/**
+ * @brief
+ * The header of a segment in use: its sequence number,
+ * one more than the previous segment's, then the magic
+ * word, programmed last.
+ */
+#define FLASH_STORE_HEADER 4
+#define FLASH_STORE_MAGIC  0x5AA5
+
+#define FLASH_STORE_ERASED 0xFFFF
+
+/**
+ * @brief In the index, for the keys
+ * never written.
+ */
+#define FLASH_STORE_NONE 0xFFFF
+
+/**
+ * @brief In _reclaim, when no
+ * segment is being reclaimed.
+ */
+#define FLASH_STORE_NO_SEGMENT FLASH_STORE_SEGMENTS
+
+/**
+ * @brief
+ * The bytes of a record in flash: key, length,
+ * the data padded to a word, CRC16 of the others.
+ * The CRC is a word too.
+ */
+#define FLASH_STORE_RECORD(length) (2 + (((length) + 1) & ~1) + 2)
+
+#define FLASH_STORE_MASK (FLASH_STORE_BUFFER_SIZE - 1)
+
+
+#if FLASH_STORE_KEYS * FLASH_STORE_RECORD(FLASH_STORE_MAX_DATA) > \
+    FLASH_STORE_SEGMENT_SIZE - FLASH_STORE_HEADER
+#error "A segment must hold the longest values of all the keys"
+#endif
+
+
+/**
+ * @brief The offset of the last record
+ * of each key in the area.
+ */
+static uint _index[FLASH_STORE_KEYS];
+
+/**
+ * @brief The segment being programmed, its
+ * sequence number, and the offset of its
+ * next record.
+ */
+static byte _head;
+static uint _sequence;
+static uint _position;
+
+/**
+ * @brief The segment after the head while it's
+ * being emptied, and the offset of its next
+ * record to move: erased once all are moved.
+ */
+static byte _reclaim = FLASH_STORE_NO_SEGMENT;
+static uint _reclaimPosition;
+
+/**
+ * @brief The records to program: added at
+ * _bufferHead, programmed from _bufferTail.
+ * Each is key, length, data.
+ */
+static byte          _buffer[FLASH_STORE_BUFFER_SIZE];
+static volatile uint _bufferHead = 0;
+static volatile uint _bufferTail = 0;
+
+/**
+ * @brief A record being programmed.
+ */
+static byte _record[FLASH_STORE_RECORD(FLASH_STORE_MAX_DATA)];
+
+
+/**
+ * @brief Adds a byte at the given position,
+ * which is moved to the next byte.
+ */
+#define FLASH_STORE_PUT(position, data)                 \
+    {                                                   \
+        _buffer[position] = (byte)(data);               \
+        position = (position + 1) & FLASH_STORE_MASK;   \
+    }
+
+
+static void _scan(byte segment);
+static void _open(byte segment);
+static void _setReclaim(void);
+static void _moveRecord(void);
+static void _programBuffered(void);
+static uint _parse(uint offset, uint end, bool* valid);
+static bool _isBlank(byte segment);
+static void _program(uint offset, const byte* data, uint length);
+static void _erase(byte segment);
+
+static inline const byte* _at(uint offset)
+{
+    return FLASH_STORE_BASE + offset;
+}
+
+static inline uint _word(uint offset)
+{
+    return _at(offset)[0] | ((uint)_at(offset)[1] << 8);
+}
+
+static inline uint _start(byte segment)
+{
+    return (uint)segment * FLASH_STORE_SEGMENT_SIZE;
+}
+
+static inline uint _end(byte segment)
+{
+    return _start(segment) + FLASH_STORE_SEGMENT_SIZE;
+}
+
+static inline byte _next(byte segment)
+{
+    return (segment + 1 < FLASH_STORE_SEGMENTS) ? segment + 1 : 0;
+}
+
+static inline bool _inUse(byte segment)
+{
+    return _word(_start(segment) + 2) == FLASH_STORE_MAGIC;
+}
+
+
+void initFlashStore(void)
+{
+    byte segment, next, key;
+    bool found = false;
+
+    for (key = 0; key < FLASH_STORE_KEYS; key++)
+        _index[key] = FLASH_STORE_NONE;
+
+    _bufferHead = 0;
+    _bufferTail = 0;
+    _reclaim    = FLASH_STORE_NO_SEGMENT;
+
+    // The head is the segment in use not
+    // followed by its successor
+    for (segment = 0; segment < FLASH_STORE_SEGMENTS; segment++)
+    {
+        if (!_inUse(segment))
+        {
+            // Reset while erasing
+            if (!_isBlank(segment))
+                _erase(segment);
+
+            continue;
+        }
+
+        next = _next(segment);
+
+        if (!_inUse(next) ||
+            _word(_start(next)) != ((_word(_start(segment)) + 1) & 0xFFFF))
+        {
+            _head = segment;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        _sequence = 0;
+        _head     = FLASH_STORE_SEGMENTS - 1;
+        _open(0);
+        return;
+    }
+
+    // From the oldest to the head
+    segment = _head;
+    do
+    {
+        segment = _next(segment);
+
+        if (_inUse(segment))
+            _scan(segment);
+    }
+    while (segment != _head);
+
+    _sequence = _word(_start(_head));
+    _setReclaim();
+}
+
+
+bool flashStoreWrite(byte key, const void* data, byte length)
+{
+    register uint position;
+    const byte* bytes   = (const byte*)data;
+    bool        written = false;
+    byte        i;
+
+    if (key >= FLASH_STORE_KEYS || length > FLASH_STORE_MAX_DATA)
+        return false;
+
+    // The interrupts can write too:
+    // a record is added at once
+    ATOMIC
+    (
+        position = _bufferHead;
+
+        // A byte is kept free to tell
+        // a full buffer from an empty one
+        if (((_bufferTail - position - 1) & FLASH_STORE_MASK) >= (uint)length + 2)
+        {
+            FLASH_STORE_PUT(position, key);
+            FLASH_STORE_PUT(position, length);
+
+            for (i = 0; i < length; i++)
+                FLASH_STORE_PUT(position, bytes[i]);
+
+            _bufferHead = position;
+            written     = true;
+        }
+    );
+
+    return written;
+}
+
+
+bool flashStoreRead(byte key, void* data, byte size, byte* length)
+{
+    uint position = _bufferTail;
+    uint head     = _bufferHead;
+    uint found    = FLASH_STORE_NONE;
+    byte* bytes   = (byte*)data;
+    byte  i;
+
+    if (key >= FLASH_STORE_KEYS)
+        return false;
+
+    // The newest buffered record
+    while (position != head)
+    {
+        if (_buffer[position] == key)
+            found = position;
+
+        position = (position + 2 +
+            _buffer[(position + 1) & FLASH_STORE_MASK]) & FLASH_STORE_MASK;
+    }
+
+    if (found != FLASH_STORE_NONE)
+    {
+        *length = _buffer[(found + 1) & FLASH_STORE_MASK];
+
+        for (i = 0; i < *length && i < size; i++)
+            bytes[i] = _buffer[(found + 2 + i) & FLASH_STORE_MASK];
+
+        return true;
+    }
+
+    if (_index[key] == FLASH_STORE_NONE)
+        return false;
+
+    *length = _at(_index[key])[1];
+
+    for (i = 0; i < *length && i < size; i++)
+        bytes[i] = _at(_index[key])[2 + i];
+
+    return true;
+}
+
+
+bool flashStorePoll(bool mayErase)
+{
+    byte length;
+
+    // The oldest records first: they
+    // must fit in the new head
+    if (_reclaim != FLASH_STORE_NO_SEGMENT &&
+        _reclaimPosition < _end(_reclaim))
+    {
+        _moveRecord();
+        return false;
+    }
+
+    if (_reclaim != FLASH_STORE_NO_SEGMENT && mayErase)
+    {
+        _erase(_reclaim);
+        _reclaim = FLASH_STORE_NO_SEGMENT;
+        return false;
+    }
+
+    if (_bufferTail == _bufferHead)
+        return true;
+
+    length = _buffer[(_bufferTail + 1) & FLASH_STORE_MASK];
+
+    if (_position + FLASH_STORE_RECORD(length) > _end(_head))
+    {
+        // Waiting for the erase, not done
+        if (_reclaim != FLASH_STORE_NO_SEGMENT)
+            return false;
+
+        _open(_next(_head));
+        return false;
+    }
+
+    _programBuffered();
+    return false;
+}
+
+
+/**
+ * @brief Adds the valid records of a
+ * segment to the index.
+ */
+static void _scan(byte segment)
+{
+    uint offset = _start(segment) + FLASH_STORE_HEADER;
+    uint end    = _end(segment);
+    uint size;
+    bool valid;
+
+    while ((size = _parse(offset, end, &valid)) != 0)
+    {
+        if (valid)
+            _index[_at(offset)[0]] = offset;
+
+        offset += size;
+    }
+
+    if (segment != _head)
+        return;
+
+    // After a broken record, the rest of the head
+    // may not be erased: the next record opens
+    // the next segment
+    _position =
+        (offset < end && _word(offset) != FLASH_STORE_ERASED) ? end : offset;
+}
+
+
+/**
+ * @brief Starts programming the next
+ * segment, which is erased.
+ */
+static void _open(byte segment)
+{
+    byte header[FLASH_STORE_HEADER];
+
+    _sequence++;
+
+    header[0] = (byte)_sequence;
+    header[1] = (byte)(_sequence >> 8);
+    header[2] = (byte)FLASH_STORE_MAGIC;
+    header[3] = (byte)(FLASH_STORE_MAGIC >> 8);
+
+    // The magic word last: a reset before
+    // it leaves the segment unused
+    _program(_start(segment),     &header[0], 2);
+    _program(_start(segment) + 2, &header[2], 2);
+
+    _head     = segment;
+    _position = _start(segment) + FLASH_STORE_HEADER;
+
+    _setReclaim();
+}
+
+
+/**
+ * @brief The segment after the head, the oldest,
+ * must be emptied if in use.
+ */
+static void _setReclaim(void)
+{
+    byte next = _next(_head);
+
+    if (next == _head || !_inUse(next))
+    {
+        _reclaim = FLASH_STORE_NO_SEGMENT;
+        return;
+    }
+
+    _reclaim         = next;
+    _reclaimPosition = _start(next) + FLASH_STORE_HEADER;
+}
+
+
+/**
+ * @brief Copies the next record of the segment being
+ * reclaimed to the head, if it's the last of its key.
+ */
+static void _moveRecord(void)
+{
+    uint size;
+    bool valid;
+    byte key;
+
+    size = _parse(_reclaimPosition, _end(_reclaim), &valid);
+
+    if (size == 0)
+    {
+        _reclaimPosition = _end(_reclaim);
+        return;
+    }
+
+    key = _at(_reclaimPosition)[0];
+
+    // As it is, CRC included
+    if (valid && _index[key] == _reclaimPosition)
+    {
+        _program(_position, _at(_reclaimPosition), size);
+        _index[key] = _position;
+        _position  += size;
+    }
+
+    _reclaimPosition += size;
+}
+
+
+/**
+ * @brief Programs the oldest buffered record
+ * in the head, where it fits.
+ */
+static void _programBuffered(void)
+{
+    uint tail   = _bufferTail;
+    byte key    = _buffer[tail];
+    byte length = _buffer[(tail + 1) & FLASH_STORE_MASK];
+    uint size   = FLASH_STORE_RECORD(length);
+    uint crc;
+    byte i;
+
+    _record[0] = key;
+    _record[1] = length;
+
+    for (i = 0; i < length; i++)
+        _record[2 + i] = _buffer[(tail + 2 + i) & FLASH_STORE_MASK];
+
+    // The padding, left erased
+    if (length & 1)
+        _record[2 + length] = 0xFF;
+
+    crc = crc16(_record, 2 + length);
+    _record[size - 2] = (byte)crc;
+    _record[size - 1] = (byte)(crc >> 8);
+
+    _program(_position, _record, size);
+    _index[key] = _position;
+    _position  += size;
+
+    _bufferTail = (tail + 2 + length) & FLASH_STORE_MASK;
+}
+
+
+/**
+ * @brief
+ * Checks a record.
+ *
+ * @param valid
+ *      Set if its key and CRC are right.
+ *
+ * @returns
+ *      Its size in flash, 0 after the last record
+ *      of the segment or if it can't be a record.
+ */
+static uint _parse(uint offset, uint end, bool* valid)
+{
+    uint header;
+    byte length;
+    uint size;
+
+    // The header may be past the area
+    if (offset + 2 > end)
+        return 0;
+
+    header = _word(offset);
+    length = (byte)(header >> 8);
+    size   = FLASH_STORE_RECORD(length);
+
+    if (header == FLASH_STORE_ERASED ||
+        length > FLASH_STORE_MAX_DATA ||
+        offset + size > end)
+        return 0;
+
+    *valid =
+        (byte)header < FLASH_STORE_KEYS &&
+        crc16(_at(offset), 2 + length) == _word(offset + size - 2);
+
+    return size;
+}
+
+
+static bool _isBlank(byte segment)
+{
+    uint offset;
+
+    for (offset = _start(segment); offset < _end(segment); offset += 2)
+        if (_word(offset) != FLASH_STORE_ERASED)
+            return false;
+
+    return true;
+}
+
+
+/**
+ * @brief
+ * Programs some words: the CPU is halted
+ * for each one, the interrupts pending
+ * run in between.
+ */
+static void _program(uint offset, const byte* data, uint length)
+{
+    uint i;
+
+    for (i = 0; i < length; i += 2)
+    {
+        ATOMIC
+        (
+            FCTL3 = FWKEY;          // Unlocked
+            FCTL1 = FWKEY + WRT;
+            FLASH_WRITE_WORD(
+                FLASH_STORE_BASE + offset + i,
+                data[i] | ((uint)data[i + 1] << 8));
+            FCTL1 = FWKEY;
+            FCTL3 = FWKEY + LOCK;
+        );
+    }
+}
+
+
+/**
+ * @brief
+ * Erases a segment: the CPU is halted
+ * until it's over.
+ */
+static void _erase(byte segment)
+{
+    ATOMIC
+    (
+        FCTL3 = FWKEY;
+        FCTL1 = FWKEY + ERASE;
+        FLASH_WRITE_WORD(FLASH_STORE_BASE + _start(segment), 0);
+        FCTL1 = FWKEY;
+        FCTL3 = FWKEY + LOCK;
+    );
+}
+
+
+#endif // !FLASH_STORE_C
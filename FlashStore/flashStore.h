@@ -0,0 +1,164 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief
+ * An append-only store of small records in flash, each
+ * a key and up to FLASH_STORE_MAX_DATA bytes: reading a
+ * key gives the value written last.
+ *
+ * The segments of the area are used in turn, as a ring:
+ * the records are programmed one after the other, and
+ * when the ring is full the oldest segment's records
+ * still current are copied to the newest one, and it's
+ * erased. Every segment is erased as often as the
+ * others.
+ *
+ * Each record has a CRC16 (crc16.h): the ones broken by
+ * a reset while being programmed are ignored.
+ *
+ * The writes only fill a RAM buffer, from the main loop
+ * or the interrupts: flashStorePoll programs them later.
+ * The CPU is halted while a word is programmed (up to
+ * 85 us) and while a segment is erased (up to 32 ms),
+ * with the interrupts pending: the words are programmed
+ * one at a time, the erases only when allowed.
+ */
+
+
+#ifndef FLASH_STORE_BASE
+/**
+ * @brief
+ * The first byte of the area, at the start of a
+ * segment. Here the 2 KB before the segment with
+ * the interrupt vectors: the linker configuration
+ * must keep the code out of it.
+ */
+#define FLASH_STORE_BASE ((byte*)0xF600)
+#endif // !FLASH_STORE_BASE
+
+
+#ifndef FLASH_STORE_SEGMENT_SIZE
+/**
+ * @brief
+ * The size of the segments of the area: 512 in main
+ * flash, 128 in information memory (B, C and D, A
+ * is locked).
+ */
+#define FLASH_STORE_SEGMENT_SIZE 512
+#endif // !FLASH_STORE_SEGMENT_SIZE
+
+
+#ifndef FLASH_STORE_SEGMENTS
+/**
+ * @brief The segments of the area, at least 2.
+ */
+#define FLASH_STORE_SEGMENTS 4
+#endif // !FLASH_STORE_SEGMENTS
+
+
+#ifndef FLASH_STORE_KEYS
+/**
+ * @brief The keys are 0 to FLASH_STORE_KEYS - 1.
+ */
+#define FLASH_STORE_KEYS 16
+#endif // !FLASH_STORE_KEYS
+
+
+#ifndef FLASH_STORE_MAX_DATA
+/**
+ * @brief
+ * The longest value. A segment must hold the
+ * longest values of all the keys, to receive
+ * the ones of the oldest segment.
+ */
+#define FLASH_STORE_MAX_DATA 16
+#endif // !FLASH_STORE_MAX_DATA
+
+
+#ifndef FLASH_STORE_BUFFER_SIZE
+/**
+ * @brief
+ * The size of the RAM buffer of the records
+ * to program, a power of 2. Each takes its
+ * length plus 2 bytes.
+ */
+#define FLASH_STORE_BUFFER_SIZE 128
+#endif // !FLASH_STORE_BUFFER_SIZE
+
+
+#ifndef FLASH_WRITE_WORD
+/**
+ * @brief
+ * Writes a word of flash: programs it, or erases
+ * its segment, as set in FCTL1.
+ */
+#define FLASH_WRITE_WORD(address, value) \
+    (*(volatile uint*)(address) = (value))
+#endif // !FLASH_WRITE_WORD
+
+
+/**
+ * @brief
+ * Finds the records in the flash and builds the
+ * index of the last ones. The segments left broken
+ * by a reset while erasing are erased now.
+ */
+void initFlashStore(void);
+
+
+/**
+ * @brief
+ * Adds a record to the RAM buffer,
+ * from the main loop or the interrupts.
+ *
+ * @returns
+ *      False if the buffer is full, the key
+ *      is out of range or the data too long.
+ */
+bool flashStoreWrite(byte key, const void* data, byte length);
+
+
+/**
+ * @brief
+ * Reads the last value of a key, also if
+ * still in the buffer. From the main loop.
+ *
+ * @param size
+ *      The size of data: a longer
+ *      value is truncated.
+ *
+ * @param length
+ *      The length of the value.
+ *
+ * @returns
+ *      False if the key was never written.
+ */
+bool flashStoreRead(byte key, void* data, byte size, byte* length);
+
+
+/**
+ * @brief
+ * Programs the next buffered record (or one of
+ * the oldest segment's, being moved), without
+ * blocking the interrupts for more than a word.
+ * Called by the main loop.
+ *
+ * @param mayErase
+ *      Whether the oldest segment can be erased
+ *      now, if due: the CPU then stops for up to
+ *      32 ms. Until it's erased, the records that
+ *      don't fit wait in the buffer.
+ *
+ * @returns
+ *      True if there is nothing left to do: false
+ *      while records wait for an erase not allowed.
+ */
+bool flashStorePoll(bool mayErase);
+
+
+#endif // !FLASH_STORE_H
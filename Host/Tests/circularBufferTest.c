@@ -0,0 +1,143 @@
+#include "test.h"
+#include "circularBuffer.h"
+
+
+static void testFillAndEmpty(void)
+{
+    CircularBuffer cb;
+    byte data;
+    uint i;
+
+    CHECK(cbInit(&cb, 8));
+    CHECK(cbIsEmpty(&cb));
+    CHECK(!cbRead(&cb, &data));
+
+    for (i = 0; i < 8; i++)
+        CHECK(cbWrite(&cb, (byte)i));
+
+    CHECK(cbIsFull(&cb));
+    CHECK(!cbWrite(&cb, 8));
+
+    for (i = 0; i < 8; i++)
+    {
+        CHECK(cbRead(&cb, &data));
+        CHECK_EQUAL(i, data);
+    }
+
+    CHECK(cbIsEmpty(&cb));
+    cbFree(&cb);
+}
+
+
+static void testWrapAround(void)
+{
+    CircularBuffer cb;
+    byte data;
+    uint i;
+
+    CHECK(cbInit(&cb, 5));
+
+    // Three bytes in, two out: the indexes 
+    // go past the end several times
+    for (i = 0; i < 20; i++)
+    {
+        CHECK(cbWrite(&cb, (byte)(3 * i)));
+        CHECK(cbWrite(&cb, (byte)(3 * i + 1)));
+        CHECK(cbWrite(&cb, (byte)(3 * i + 2)));
+
+        CHECK(cbRead(&cb, &data));
+        CHECK(cbRead(&cb, &data));
+        CHECK(cbRead(&cb, &data));
+        CHECK_EQUAL((byte)(3 * i + 2), data);
+    }
+
+    CHECK(cbIsEmpty(&cb));
+    CHECK(cb.w_pos < cb.size && cb.r_pos == cb.w_pos);
+    cbFree(&cb);
+}
+
+
+static void testWriteInPlace(void)
+{
+    CircularBuffer cb;
+    byte* start;
+    byte data;
+    uint i;
+
+    CHECK(cbInit(&cb, 8));
+
+    for (i = 0; i < 6; i++)
+        cbWrite(&cb, 0);
+
+    for (i = 0; i < 4; i++)
+        cbRead(&cb, &data);
+
+    // Free: 6 bytes, only 2 before the end
+    CHECK_EQUAL(2, cbWriteSpace(&cb, &start));
+    CHECK(start == cb.buff + 6);
+
+    start[0] = 'a';
+    start[1] = 'b';
+    cbWriteCommit(&cb, 2);
+
+    CHECK_EQUAL(0, cb.w_pos);
+    CHECK_EQUAL(4, cbWriteSpace(&cb, &start));
+    CHECK(start == cb.buff);
+
+    start[0] = 'c';
+    cbWriteCommit(&cb, 1);
+
+    cbRead(&cb, &data);
+    cbRead(&cb, &data);
+    CHECK(cbRead(&cb, &data) && data == 'a');
+    CHECK(cbRead(&cb, &data) && data == 'b');
+    CHECK(cbRead(&cb, &data) && data == 'c');
+    CHECK(cbIsEmpty(&cb));
+    cbFree(&cb);
+}
+
+
+static void testArenaFallback(void)
+{
+    CircularBuffer buffers[MEMORY_POOL0_BLOCKS + MEMORY_POOL2_BLOCKS + 1];
+    MemoryStats before;
+    MemoryStats after;
+    uint i;
+
+    memGetStats(&before);
+
+    // The pools run out, the last one 
+    // comes from the arena
+    for (i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+        CHECK(cbInit(&buffers[i], 32));
+
+    memGetStats(&after);
+    CHECK_EQUAL(before.failures, after.failures);
+    CHECK(after.arenaUsed > before.arenaUsed);
+
+    for (i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+        cbFree(&buffers[i]);
+}
+
+
+static void testOutOfMemory(void)
+{
+    CircularBuffer cb;
+
+    // Bigger than the pools and the arena
+    CHECK(!cbInit(&cb, 0xFFFF));
+    CHECK_EQUAL(0, cb.size);
+    CHECK(!cbWrite(&cb, 0));
+}
+
+
+int main(void)
+{
+    RUN_TEST(testFillAndEmpty);
+    RUN_TEST(testWrapAround);
+    RUN_TEST(testWriteInPlace);
+    RUN_TEST(testArenaFallback);
+    RUN_TEST(testOutOfMemory);
+
+    return TEST_RESULT();
+}
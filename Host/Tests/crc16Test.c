@@ -0,0 +1,40 @@
+#include "test.h"
+#include "crc16.h"
+
+
+static const byte _check[] = "123456789";
+
+
+static void testCheckValue(void)
+{
+    CHECK_EQUAL(CRC16_CHECK, crc16(_check, 9));
+    CHECK_EQUAL(CRC16_CHECK, crc16Software(CRC16_INIT, _check, 9));
+}
+
+
+static void testBlocks(void)
+{
+    byte data[200];
+    uint crc;
+    uint i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (byte)(i * 31 + 7);
+
+    // In parts, short and long (DMA)
+    crc = crc16Update(CRC16_INIT, data, 5);
+    crc = crc16UpdateDma(crc, data + 5, 3);
+    crc = crc16UpdateDma(crc, data + 8, sizeof(data) - 8);
+
+    CHECK_EQUAL(crc16Software(CRC16_INIT, data, sizeof(data)), crc);
+    CHECK_EQUAL(CRC16_INIT, crc16Update(CRC16_INIT, data, 0));
+}
+
+
+int main(void)
+{
+    RUN_TEST(testCheckValue);
+    RUN_TEST(testBlocks);
+
+    return TEST_RESULT();
+}
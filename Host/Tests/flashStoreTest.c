@@ -0,0 +1,208 @@
+#include <string.h>
+#include "test.h"
+#include "flashStore.h"
+
+
+/**
+ * @brief The last value written to each key, 
+ * a 16 bits counter and its length.
+ */
+static uint _expected[FLASH_STORE_KEYS];
+static bool _written[FLASH_STORE_KEYS];
+
+
+#define LENGTH(key) (2 + ((key) & 3))
+
+
+static void _checkAll(void)
+{
+    byte data[FLASH_STORE_MAX_DATA];
+    byte key;
+    byte length;
+
+    for (key = 0; key < FLASH_STORE_KEYS; key++)
+    {
+        bool found = flashStoreRead(key, data, sizeof(data), &length);
+
+        CHECK_EQUAL(_written[key], found);
+
+        if (found && _written[key])
+        {
+            CHECK_EQUAL(LENGTH(key), length);
+            CHECK_EQUAL(_expected[key], data[0] | (data[1] << 8));
+        }
+    }
+}
+
+
+static void _drain(void)
+{
+    while (!flashStorePoll(true))
+        ;
+}
+
+
+/**
+ * @brief Starts from an erased area.
+ */
+static void _erased(void)
+{
+    simFlashErase();
+    memset(_written, 0, sizeof(_written));
+    initFlashStore();
+}
+
+
+static void testEmpty(void)
+{
+    _erased();
+    _checkAll();
+    CHECK(flashStorePoll(true));
+}
+
+
+static void testLimits(void)
+{
+    byte data[FLASH_STORE_MAX_DATA + 1] = { 0 };
+
+    _erased();
+
+    CHECK(!flashStoreWrite(FLASH_STORE_KEYS, data, 1));
+    CHECK(!flashStoreWrite(0, data, FLASH_STORE_MAX_DATA + 1));
+    CHECK(flashStoreWrite(0, data, FLASH_STORE_MAX_DATA));
+}
+
+
+static void testWearAndResets(void)
+{
+    byte data[FLASH_STORE_MAX_DATA];
+    uint i;
+
+    _erased();
+    memset(data, 0xEE, sizeof(data));
+
+    // The ring is filled and reclaimed many times
+    for (i = 0; i < 3000; i++)
+    {
+        byte key = (byte)((i * 7) % FLASH_STORE_KEYS);
+
+        data[0] = (byte)i;
+        data[1] = (byte)(i >> 8);
+
+        if (!flashStoreWrite(key, data, LENGTH(key)))
+        {
+            _drain();
+            CHECK(flashStoreWrite(key, data, LENGTH(key)));
+        }
+
+        _expected[key] = i;
+        _written[key]  = true;
+
+        // Read also from the buffer
+        if (i % 10 == 0)
+            _checkAll();
+
+        if (i % 5 == 0)
+            flashStorePoll(i % 3 == 0);
+
+        // The flash is kept, the RAM is lost
+        if (i % 97 == 0)
+        {
+            _drain();
+            simReset();
+            initFlashStore();
+            _checkAll();
+        }
+    }
+
+    _drain();
+    _checkAll();
+}
+
+
+static void testTornRecord(void)
+{
+    byte data[4] = { 1, 2, 3, 4 };
+    int  last;
+
+    _erased();
+
+    CHECK(flashStoreWrite(3, data, sizeof(data)));
+    _drain();
+
+    // A reset while its last word was programmed
+    for (last = SIM_FLASH_SIZE - 2; last > 0; last -= 2)
+        if (simFlash[last] != 0xFF || simFlash[last + 1] != 0xFF)
+            break;
+
+    simFlash[last] ^= 0x01;
+    simReset();
+    initFlashStore();
+
+    _checkAll();
+
+    // The store goes on after it
+    data[0] = 0x34;
+    data[1] = 0x12;
+    CHECK(flashStoreWrite(3, data, LENGTH(3)));
+    _drain();
+
+    _expected[3] = 0x1234;
+    _written[3]  = true;
+
+    simReset();
+    initFlashStore();
+    _checkAll();
+}
+
+
+static void testWaitingForErase(void)
+{
+    byte data[FLASH_STORE_MAX_DATA] = { 0 };
+    uint i;
+    uint polls;
+
+    _erased();
+
+    // Without the erase, the ring fills up and
+    // the records wait in the buffer
+    for (i = 0; i < 1000; i++)
+    {
+        byte key = (byte)(i % FLASH_STORE_KEYS);
+
+        data[0] = (byte)i;
+        data[1] = (byte)(i >> 8);
+
+        if (!flashStoreWrite(key, data, LENGTH(key)))
+            break;
+
+        _expected[key] = i;
+        _written[key]  = true;
+
+        for (polls = 0; polls < 20; polls++)
+            flashStorePoll(false);
+    }
+
+    CHECK(i < 1000);
+    CHECK(!flashStorePoll(false));
+    _checkAll();
+
+    _drain();
+    _checkAll();
+
+    simReset();
+    initFlashStore();
+    _checkAll();
+}
+
+
+int main(void)
+{
+    RUN_TEST(testEmpty);
+    RUN_TEST(testLimits);
+    RUN_TEST(testWearAndResets);
+    RUN_TEST(testTornRecord);
+    RUN_TEST(testWaitingForErase);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,151 @@
+#include "test.h"
+#include "linkedList.h"
+
+
+static int _values[] = { 0, 1, 2, 3, 4 };
+
+
+/**
+ * @brief The pool blocks in use.
+ */
+static uint _used(void)
+{
+    MemoryStats stats;
+    uint used = 0;
+    byte i;
+
+    memGetStats(&stats);
+
+    for (i = 0; i < MEMORY_POOLS; i++)
+        used += stats.poolUsed[i];
+
+    return used;
+}
+
+
+/**
+ * @brief A list of the values from first to last.
+ */
+static Node* _list(int first, int last)
+{
+    Node* start = createNode(&_values[first], NULL, NULL);
+    int i;
+
+    for (i = first + 1; i <= last; i++)
+        llAdd(start, &_values[i]);
+
+    return start;
+}
+
+
+static void testAddAndIndex(void)
+{
+    uint used = _used();
+    Node* start = _list(0, 4);
+    int i;
+
+    CHECK_EQUAL(5, llLength(start));
+    CHECK_EQUAL(used + 5, _used());
+
+    for (i = 0; i < 5; i++)
+        CHECK(llElementAt(start, i)->content == &_values[i]);
+
+    CHECK(llElementAt(start, 5) == NULL);
+    CHECK(llElementAt(start, -1) == NULL);
+    CHECK(llGetLast(start)->content == &_values[4]);
+    CHECK(llGetFirst(llGetLast(start)) == start);
+
+    llClear(&start, false);
+    CHECK_EQUAL(used, _used());
+}
+
+
+static void testInsert(void)
+{
+    Node* start = _list(0, 1);
+    Node* node  = createNode(&_values[4], NULL, NULL);
+
+    // After the node at the index
+    llInsertAt(start, node, 0);
+
+    CHECK_EQUAL(3, llLength(start));
+    CHECK(llElementAt(start, 1) == node);
+    CHECK(node->previous == start);
+    CHECK(node->next->content == &_values[1]);
+    CHECK(node->next->previous == node);
+
+    llClear(&start, false);
+}
+
+
+static void testRemove(void)
+{
+    uint used = _used();
+    Node* start = _list(0, 4);
+
+    // The first: the start moves
+    llRemoveAt(&start, 0, false);
+    CHECK(start->content == &_values[1]);
+    CHECK(start->previous == NULL);
+
+    // In the middle
+    llRemove(&start, llElementAt(start, 1), false);
+    CHECK_EQUAL(3, llLength(start));
+    CHECK(llElementAt(start, 1)->content == &_values[3]);
+    CHECK(llElementAt(start, 1)->previous == start);
+
+    llRemoveLast(&start, false);
+    CHECK_EQUAL(2, llLength(start));
+    CHECK(llGetLast(start)->next == NULL);
+
+    llRemoveLast(&start, false);
+    llRemoveLast(&start, false);
+    CHECK(start == NULL);
+    CHECK_EQUAL(used, _used());
+}
+
+
+static void testUnlink(void)
+{
+    Node* start = _list(0, 2);
+    Node* other = createNode(&_values[3], NULL, NULL);
+    Node* middle = start->next;
+
+    CHECK(!llUnlink(&start, other));
+    CHECK(llUnlink(&start, middle));
+    CHECK_EQUAL(2, llLength(start));
+    CHECK(start->next->content == &_values[2]);
+
+    // Not freed: it can be added again
+    llLinkThree(start, middle, start->next);
+    CHECK_EQUAL(3, llLength(start));
+    CHECK(llElementAt(start, 1) == middle);
+
+    llClear(&start, false);
+    llClear(&other, false);
+}
+
+
+static void testOutOfMemory(void)
+{
+    Node* start = createNode(&_values[0], NULL, NULL);
+    int added = 1;
+
+    while (llAdd(start, &_values[1]) != NULL)
+        added++;
+
+    CHECK_EQUAL(added, llLength(start));
+    llClear(&start, false);
+}
+
+
+int main(void)
+{
+    RUN_TEST(testAddAndIndex);
+    RUN_TEST(testInsert);
+    RUN_TEST(testRemove);
+    RUN_TEST(testUnlink);
+    RUN_TEST(testOutOfMemory);
+
+    return TEST_RESULT();
+}
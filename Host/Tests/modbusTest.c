@@ -0,0 +1,254 @@
+#include <string.h>
+#include "test.h"
+#include "serial.h"
+#include "modbus.h"
+
+
+#define SLAVE 5
+
+
+static uint _holding[3];
+static uint _input[2];
+
+static const ModbusRegister _holdingMap[] =
+{
+    { 100, &_holding[0] },
+    { 101, &_holding[1] },
+    { 105, &_holding[2] }
+};
+
+static const ModbusRegister _inputMap[] =
+{
+    { 0, &_input[0] },
+    { 1, &_input[1] }
+};
+
+
+/**
+ * @brief The last register written, for the callback.
+ */
+static uint _writtenAddress;
+static uint _writtenValue;
+
+
+/**
+ * @brief The response sent.
+ */
+static byte _response[64];
+static uint _responseLength;
+
+
+static void _written(uint address, uint value)
+{
+    _writtenAddress = address;
+    _writtenValue   = value;
+}
+
+
+/**
+ * @brief Receives a request, with its CRC if crc is
+ * set, and the t3.5 silence. The cycles between the
+ * bytes are 100, gap before the third.
+ */
+static void _request(const byte* frame, uint length, bool crc, uint gap)
+{
+    byte data[MODBUS_MAX_FRAME];
+    uint i;
+
+    memcpy(data, frame, length);
+
+    if (crc)
+    {
+        uint value = modbusCrc(frame, length);
+
+        data[length++] = (byte)value;
+        data[length++] = (byte)(value >> 8);
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        TA2R += (i == 2) ? gap : 100;
+        simSerialReceive(data[i]);
+    }
+
+    TA2R += 2000;
+    TA2IV = TA2IV_TA2CCR1;
+    simRaise(TIMER2_A1_VECTOR);
+}
+
+
+/**
+ * @brief Serves the request, collecting the response.
+ */
+static bool _poll(void)
+{
+    bool served = modbusPoll();
+    int  data;
+
+    _responseLength = 0;
+
+    while ((data = simSerialTransmit()) != SIM_NO_DATA)
+        if (_responseLength < sizeof(_response))
+            _response[_responseLength++] = (byte)data;
+
+    return served;
+}
+
+
+/**
+ * @brief Checks the response is the given bytes 
+ * followed by their CRC.
+ */
+static bool _responded(const byte* expected, uint length)
+{
+    return _responseLength == length + 2
+        && memcmp(_response, expected, length) == 0
+        && modbusCrc(_response, _responseLength) == 0;
+}
+
+
+static void _open(void)
+{
+    _holding[0] = 10;
+    _holding[1] = 20;
+    _holding[2] = 30;
+    _input[0]   = 7;
+    _input[1]   = 8;
+
+    Serial.buffSize = MODBUS_MAX_FRAME;
+    Serial.begin(BAUD_115200);
+    CHECK(initModbus(SLAVE, BAUD_115200));
+    modbusSetRegisters(_holdingMap, 3, _inputMap, 2, _written);
+}
+
+
+static void testCrc(void)
+{
+    static const byte check[] = "123456789";
+    static const byte frame[] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A };
+
+    CHECK_EQUAL(0x4B37, modbusCrc(check, 9));
+
+    // Sent as C5 CD
+    CHECK_EQUAL(0xCDC5, modbusCrc(frame, sizeof(frame)));
+}
+
+
+static void testRxBufferTooSmall(void)
+{
+    Serial.buffSize = 16;
+    Serial.begin(BAUD_115200);
+
+    CHECK(!initModbus(SLAVE, BAUD_115200));
+
+    Serial.close();
+}
+
+
+static void testRead(void)
+{
+    static const byte holding[]  = { SLAVE, 0x03, 0, 100, 0, 2 };
+    static const byte holdingR[] = { SLAVE, 0x03, 4, 0, 10, 0, 20 };
+    static const byte input[]    = { SLAVE, 0x04, 0, 0, 0, 2 };
+    static const byte inputR[]   = { SLAVE, 0x04, 4, 0, 7, 0, 8 };
+    static const byte gap[]      = { SLAVE, 0x03, 0, 100, 0, 3 };
+    static const byte gapR[]     = { SLAVE, 0x83, MODBUS_ILLEGAL_ADDRESS };
+
+    _open();
+
+    _request(holding, sizeof(holding), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(holdingR, sizeof(holdingR)));
+
+    _request(input, sizeof(input), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(inputR, sizeof(inputR)));
+
+    // 102 isn't mapped
+    _request(gap, sizeof(gap), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(gapR, sizeof(gapR)));
+
+    Serial.close();
+}
+
+
+static void testWrite(void)
+{
+    static const byte single[]   = { SLAVE, 0x06, 0, 101, 0x12, 0x34 };
+    static const byte multiple[] = { SLAVE, 0x10, 0, 100, 0, 2, 4, 0, 1, 0, 2 };
+    static const byte multipleR[] = { SLAVE, 0x10, 0, 100, 0, 2 };
+    static const byte broadcast[] = { MODBUS_BROADCAST, 0x06, 0, 105, 0, 9 };
+
+    _open();
+
+    // The request is echoed
+    _request(single, sizeof(single), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(single, sizeof(single)));
+    CHECK_EQUAL(0x1234, _holding[1]);
+    CHECK_EQUAL(101, _writtenAddress);
+    CHECK_EQUAL(0x1234, _writtenValue);
+
+    _request(multiple, sizeof(multiple), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(multipleR, sizeof(multipleR)));
+    CHECK_EQUAL(1, _holding[0]);
+    CHECK_EQUAL(2, _holding[1]);
+
+    // Served, never answered
+    _request(broadcast, sizeof(broadcast), true, 100);
+    CHECK(_poll());
+    CHECK_EQUAL(0, _responseLength);
+    CHECK_EQUAL(9, _holding[2]);
+
+    Serial.close();
+}
+
+
+static void testDiscarded(void)
+{
+    static const byte request[] = { SLAVE, 0x03, 0, 100, 0, 1 };
+    static const byte other[]   = { SLAVE + 1, 0x03, 0, 100, 0, 1 };
+    static const byte unknown[] = { SLAVE, 0x07 };
+    static const byte unknownR[] = { SLAVE, 0x87, MODBUS_ILLEGAL_FUNCTION };
+    ModbusStats stats;
+
+    _open();
+    modbusGetStats(&stats, true);
+
+    _request(other, sizeof(other), true, 100);
+    CHECK(!_poll());
+    CHECK_EQUAL(0, _responseLength);
+
+    _request(request, sizeof(request), false, 100);
+    CHECK(!_poll());
+
+    // A t1.5 silence inside the frame
+    _request(request, sizeof(request), true, 900);
+    CHECK(!_poll());
+
+    _request(unknown, sizeof(unknown), true, 100);
+    CHECK(_poll());
+    CHECK(_responded(unknownR, sizeof(unknownR)));
+
+    modbusGetStats(&stats, false);
+    CHECK_EQUAL(1, stats.requests);
+    CHECK_EQUAL(1, stats.crcErrors);
+    CHECK_EQUAL(1, stats.discarded);
+    CHECK_EQUAL(1, stats.exceptions);
+
+    Serial.close();
+}
+
+
+int main(void)
+{
+    RUN_TEST(testCrc);
+    RUN_TEST(testRxBufferTooSmall);
+    RUN_TEST(testRead);
+    RUN_TEST(testWrite);
+    RUN_TEST(testDiscarded);
+
+    return TEST_RESULT();
+}
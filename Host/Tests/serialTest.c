@@ -0,0 +1,171 @@
+#include <string.h>
+#include "test.h"
+#include "serial.h"
+#include "serialFormat.h"
+
+
+/**
+ * @brief The bytes sent by UCA1.
+ */
+static char _sent[128];
+static uint _sentLength;
+
+
+/**
+ * @brief Sends all the bytes the port has.
+ */
+static void _transmit(void)
+{
+    int data;
+
+    while ((data = simSerialTransmit()) != SIM_NO_DATA)
+        if (_sentLength < sizeof(_sent) - 1)
+            _sent[_sentLength++] = (char)data;
+
+    _sent[_sentLength] = '\0';
+}
+
+
+/**
+ * @brief The CPU waits: the line takes the bytes.
+ */
+static void _idle(unsigned short lpmBits)
+{
+    _transmit();
+}
+
+
+static void _receive(const char* text)
+{
+    while (*text != '\0')
+        simSerialReceive((byte)*text++);
+}
+
+
+static void _open(void)
+{
+    _sentLength = 0;
+    _sent[0]    = '\0';
+
+    Serial.buffSize = 16;
+    Serial.begin(BAUD_9600);
+}
+
+
+static void testWriteAsync(void)
+{
+    _open();
+
+    CHECK(Serial.writeCharAsync('A'));
+    CHECK_EQUAL(2, Serial.writeBuffAsync((const byte*)"BC", 2));
+    _transmit();
+    CHECK(strcmp(_sent, "ABC") == 0);
+
+    // Only what fits in the tx buffer
+    CHECK_EQUAL(16, Serial.writeBuffAsync((const byte*)"0123456789abcdefXYZ", 19));
+    _transmit();
+    CHECK(strcmp(_sent, "ABC0123456789abcdef") == 0);
+
+    Serial.close();
+}
+
+
+static void testWriteBlocking(void)
+{
+    const char* text = "longer than the tx buffer";
+
+    _open();
+    simIdleHook = _idle;
+
+    Serial.writeBuff((const byte*)text, strlen(text));
+    _transmit();
+    CHECK(strcmp(_sent, text) == 0);
+
+    Serial.close();
+}
+
+
+static void testReadUntil(void)
+{
+    byte line[8];
+    uint length = 0;
+    byte data;
+
+    _open();
+
+    _receive("ab");
+    CHECK(!Serial.readUntilAsync(line, sizeof(line), '\n', &length));
+    CHECK_EQUAL(2, length);
+
+    _receive("c\nd");
+    CHECK(Serial.readUntilAsync(line, sizeof(line), '\n', &length));
+    CHECK_EQUAL(3, length);
+    CHECK(memcmp(line, "abc", 3) == 0);
+
+    CHECK(Serial.readCharAsync(&data) && data == 'd');
+    CHECK(!Serial.readCharAsync(&data));
+
+    Serial.close();
+}
+
+
+static void testReceiveErrors(void)
+{
+    SerialErrors errors;
+    byte data;
+    uint i;
+
+    _open();
+    serialGetErrors(&errors, true);
+
+    // The rx buffer holds 16
+    for (i = 0; i < 20; i++)
+        simSerialReceive((byte)i);
+
+    UCA1STAT = UCFE;
+    simSerialReceive('x');
+    UCA1STAT = UCOE;
+    simSerialReceive('y');
+    UCA1STAT = 0;
+
+    serialGetErrors(&errors, true);
+    CHECK_EQUAL(1, errors.framingErrors);
+    CHECK_EQUAL(1, errors.overruns);
+    CHECK_EQUAL(5, errors.dropped);
+
+    for (i = 0; i < 16; i++)
+        CHECK(Serial.readCharAsync(&data) && data == i);
+
+    serialGetErrors(&errors, false);
+    CHECK_EQUAL(0, errors.dropped);
+
+    Serial.close();
+}
+
+
+static void testFormat(void)
+{
+    _open();
+    simIdleHook = _idle;
+
+    CHECK(serialPrintf("%d|%5u|%04X|%s|%c|%%", -42, 7U, 0x2AU, "text", 'z'));
+    CHECK(serialPrintFixed(-1234, 2, 0));
+    _transmit();
+    CHECK(strcmp(_sent, "-42|    7|002A|text|z|%-12.34") == 0);
+
+    // Nothing would ever be sent
+    Serial.close();
+    CHECK(!serialPrintString("closed"));
+}
+
+
+int main(void)
+{
+    RUN_TEST(testWriteAsync);
+    RUN_TEST(testWriteBlocking);
+    RUN_TEST(testReadUntil);
+    RUN_TEST(testReceiveErrors);
+    RUN_TEST(testFormat);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+#include <string.h>
+#include "test.h"
+#include "serial.h"
+#include "shell.h"
+
+
+/**
+ * @brief The arguments of the last command run.
+ */
+static long _sum;
+static byte _ledArgc;
+
+
+static bool _led(byte argc, char** argv)
+{
+    _ledArgc = argc;
+    return argc == 2;
+}
+
+
+static bool _add(byte argc, char** argv)
+{
+    long a;
+    long b;
+
+    if (argc != 3 || !shellParseInt(argv[1], &a) || !shellParseInt(argv[2], &b))
+        return false;
+
+    _sum = a + b;
+    return true;
+}
+
+
+#define COMMANDS(COMMAND)                       \
+    COMMAND(led, 'l', 'd', _led, "led on|off")  \
+    COMMAND(add, 'a', 'd', _add, "add a b")
+
+SHELL_DISPATCHER(_dispatch, COMMANDS)
+
+
+/**
+ * @brief The CPU waits: the replies are sent.
+ */
+static void _idle(unsigned short lpmBits)
+{
+    while (simSerialTransmit() != SIM_NO_DATA)
+        ;
+}
+
+
+static ShellStatus _line(const char* text)
+{
+    while (*text != '\0')
+        simSerialReceive((byte)*text++);
+
+    return shellPoll();
+}
+
+
+static void _open(void)
+{
+    simIdleHook = _idle;
+
+    Serial.buffSize = 128;
+    Serial.begin(BAUD_9600);
+    initShell(_dispatch);
+}
+
+
+static void testParseNumbers(void)
+{
+    ulong u;
+    long  i;
+
+    CHECK(shellParseUInt("4294967295", &u) && u == 4294967295UL);
+    CHECK(!shellParseUInt("4294967296", &u));
+    CHECK(shellParseUInt("0x1aF", &u) && u == 0x1AF);
+    CHECK(shellParseUInt("0xFFFFFFFF", &u) && u == 0xFFFFFFFFUL);
+    CHECK(!shellParseUInt("0x100000000", &u));
+    CHECK(!shellParseUInt("0x", &u));
+    CHECK(!shellParseUInt("", &u));
+    CHECK(!shellParseUInt("12a", &u));
+    CHECK(!shellParseUInt("-1", &u));
+
+    CHECK(shellParseInt("-2147483648", &i) && i == -2147483647L - 1);
+    CHECK(!shellParseInt("2147483648", &i));
+    CHECK(shellParseInt("+17", &i) && i == 17);
+    CHECK(!shellParseInt("-0x10", &i));
+}
+
+
+static void testCommands(void)
+{
+    _open();
+
+    CHECK_EQUAL(SHELL_DONE, _line("led on\r\n"));
+    CHECK_EQUAL(2, _ledArgc);
+
+    CHECK_EQUAL(SHELL_DONE, _line("  add \t -3   40\n"));
+    CHECK_EQUAL(37, _sum);
+
+    CHECK_EQUAL(SHELL_USAGE, _line("led\n"));
+    CHECK_EQUAL(SHELL_USAGE, _line("add 1 x\n"));
+    CHECK_EQUAL(SHELL_EMPTY, _line("   \r\n"));
+
+    // The same hash as led
+    CHECK_EQUAL(SHELL_UNKNOWN, _line("lxd on\n"));
+    CHECK_EQUAL(SHELL_UNKNOWN, _line("foo\n"));
+
+    // A burst: the outcome of the last one
+    CHECK_EQUAL(SHELL_DONE, _line("foo\nadd 1 2\n"));
+    CHECK_EQUAL(3, _sum);
+
+    Serial.close();
+}
+
+
+static void testLongLines(void)
+{
+    char line[SHELL_LINE_SIZE + 16];
+
+    _open();
+
+    memset(line, 'x', sizeof(line));
+    line[sizeof(line) - 2] = '\n';
+    line[sizeof(line) - 1] = '\0';
+
+    // The end of the long line is skipped,
+    // not run as a command
+    CHECK_EQUAL(SHELL_TOO_LONG, _line(line));
+    CHECK_EQUAL(SHELL_DONE, _line("add 2 2\n"));
+    CHECK_EQUAL(4, _sum);
+
+    CHECK_EQUAL(SHELL_TOO_MANY_ARGS, _line("a b c d e f g h i\n"));
+
+    Serial.close();
+}
+
+
+int main(void)
+{
+    RUN_TEST(testParseNumbers);
+    RUN_TEST(testCommands);
+    RUN_TEST(testLongLines);
+
+    return TEST_RESULT();
+}
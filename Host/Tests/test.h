@@ -0,0 +1,74 @@
+#ifndef TEST_H
+#define TEST_H
+
+/*
+ * The checks of the host tests: each test is a program
+ * that drives the simulator (simulator.h), run by CTest,
+ * which fails if a check did.
+ */
+
+#include <stdio.h>
+#include "simulator.h"
+
+
+/**
+ * @brief The checks that failed.
+ */
+static int _testFailures = 0;
+
+
+/**
+ * @brief Checks a condition, printing 
+ * it with its line if false.
+ */
+#define CHECK(condition)                                        \
+    do                                                          \
+    {                                                           \
+        if (!(condition))                                       \
+        {                                                       \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            _testFailures++;                                    \
+        }                                                       \
+    } while (0)
+
+
+/**
+ * @brief Checks two integers are equal, 
+ * printing both if not.
+ */
+#define CHECK_EQUAL(expected, actual)                           \
+    do                                                          \
+    {                                                           \
+        long long _e = (long long)(expected);                   \
+        long long _a = (long long)(actual);                     \
+                                                                \
+        if (_e != _a)                                           \
+        {                                                       \
+            printf("%s:%d: %s is %lld, expected %lld\n",        \
+                   __FILE__, __LINE__, #actual, _a, _e);        \
+            _testFailures++;                                    \
+        }                                                       \
+    } while (0)
+
+
+/**
+ * @brief Runs a test function on 
+ * reset registers, interrupts enabled.
+ */
+#define RUN_TEST(test)          \
+    do                          \
+    {                           \
+        simReset();             \
+        simIdleHook = NULL;     \
+        __enable_interrupt();   \
+        test();                 \
+    } while (0)
+
+
+/**
+ * @brief The exit code of main.
+ */
+#define TEST_RESULT() (_testFailures == 0 ? 0 : 1)
+
+
+#endif // !TEST_H
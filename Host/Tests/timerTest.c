@@ -0,0 +1,170 @@
+#include <string.h>
+#include "test.h"
+#include "timer.h"
+
+
+static uint _fired;
+static uint _firedOther;
+
+
+static void _elapsed(void)
+{
+    _fired++;
+}
+
+
+static void _elapsedOther(void)
+{
+    _firedOther++;
+}
+
+
+static void _ticks(uint count)
+{
+    while (count-- > 0)
+        simTimerTick();
+}
+
+
+static void testOneShot(void)
+{
+    TimerInfo* timer;
+
+    initTimer0(TIMER0_MS);
+    _fired = 0;
+
+    timer = createTimerInfo(3, false, _elapsed);
+    CHECK(addManagedTimer(timer));
+
+    // Called at the interruptCalls + 1th tick
+    _ticks(3);
+    CHECK_EQUAL(0, _fired);
+
+    _ticks(1);
+    CHECK_EQUAL(1, _fired);
+
+    _ticks(10);
+    CHECK_EQUAL(1, _fired);
+
+    collectManagedTimers();
+    clearManagedTimers();
+}
+
+
+static void testAutoReset(void)
+{
+    TimerInfo* timer;
+    TimerInfo* other;
+
+    initTimer0(TIMER0_MS);
+    _fired      = 0;
+    _firedOther = 0;
+
+    timer = createTimerInfo(1, true, _elapsed);
+    other = createTimerInfo(4, true, _elapsedOther);
+    CHECK(addManagedTimer(timer));
+    CHECK(addManagedTimer(other));
+
+    _ticks(20);
+    CHECK_EQUAL(10, _fired);
+    CHECK_EQUAL(4, _firedOther);
+
+    // The other one keeps going
+    removeManagedTimer(timer, true);
+    _ticks(10);
+    CHECK_EQUAL(10, _fired);
+    CHECK_EQUAL(6, _firedOther);
+
+    clearManagedTimers();
+}
+
+
+static void testExpiredFreed(void)
+{
+    MemoryStats before;
+    MemoryStats after;
+    uint i;
+
+    initTimer0(TIMER0_MS);
+    memGetStats(&before);
+
+    for (i = 0; i < 4; i++)
+        CHECK(addManagedTimer(createTimerInfo(i, false, _elapsed)));
+
+    _ticks(5);
+
+    // Unlinked by the interrupt, freed here
+    collectManagedTimers();
+    memGetStats(&after);
+
+    for (i = 0; i < MEMORY_POOLS; i++)
+        CHECK_EQUAL(before.poolUsed[i], after.poolUsed[i]);
+}
+
+
+static void testTickWhileDisabled(void)
+{
+    initTimer0(TIMER0_MS);
+    _fired = 0;
+
+    CHECK(addManagedTimer(createTimerInfo(0, true, _elapsed)));
+
+    // Pending until the interrupts are enabled
+    __disable_interrupt();
+    simTimerTick();
+    CHECK_EQUAL(0, _fired);
+
+    __enable_interrupt();
+    CHECK_EQUAL(1, _fired);
+
+    // A stopped timer doesn't tick
+    TA0CTL &= ~MC_3;
+    simTimerTick();
+    CHECK_EQUAL(1, _fired);
+
+    clearManagedTimers();
+}
+
+
+static void testStats(void)
+{
+    TimerInfo*   timer;
+    TimerStats   stats;
+    TimerSummary summary;
+
+    initTimer0(TIMER0_MS);
+
+    timer = createTimerInfo(0, true, _elapsed);
+    CHECK(addManagedTimer(timer));
+    _ticks(3);
+
+    memset(&stats, 0xA5, sizeof(stats));
+    memset(&summary, 0xA5, sizeof(summary));
+
+    timerGetStats(timer, &stats);
+    timerSummary(&summary, true);
+
+#if TIMER_ACCOUNTING
+    CHECK_EQUAL(3, stats.runs);
+    CHECK_EQUAL(3, summary.ticks);
+#else
+    CHECK_EQUAL(0, stats.runs);
+    CHECK_EQUAL(0, stats.totalRun);
+    CHECK_EQUAL(0, summary.ticks);
+    CHECK(summary.busiest == NULL && summary.latest == NULL);
+#endif // TIMER_ACCOUNTING
+
+    clearManagedTimers();
+}
+
+
+int main(void)
+{
+    RUN_TEST(testOneShot);
+    RUN_TEST(testAutoReset);
+    RUN_TEST(testExpiredFreed);
+    RUN_TEST(testTickWhileDisabled);
+    RUN_TEST(testStats);
+
+    return TEST_RESULT();
+}
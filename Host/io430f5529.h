@@ -0,0 +1,276 @@
+#ifndef HOST_IO430F5529_H
+#define HOST_IO430F5529_H
+
+/*
+ * Host replacement of the IAR device header: the registers
+ * the library touches are plain variables (simulator.c),
+ * the intrinsics are functions of the simulator.
+ * Only on the include path of the host build (CMakeLists.txt).
+ */
+
+#include <stdint.h>
+
+
+#define __interrupt
+#define __no_init
+#define __root
+
+typedef unsigned short __istate_t;
+
+void       __enable_interrupt(void);
+void       __disable_interrupt(void);
+__istate_t __get_interrupt_state(void);
+void       __set_interrupt_state(__istate_t state);
+
+void __bis_SR_register(unsigned short bits);
+void __bic_SR_register(unsigned short bits);
+void __bis_SR_register_on_exit(unsigned short bits);
+void __bic_SR_register_on_exit(unsigned short bits);
+
+void __no_operation(void);
+void __delay_cycles(unsigned long cycles);
+void __data16_write_addr(unsigned short address, unsigned long value);
+
+unsigned short     __bcd_add_short    (unsigned short a,     unsigned short b);
+unsigned long      __bcd_add_long     (unsigned long a,      unsigned long b);
+unsigned long long __bcd_add_long_long(unsigned long long a, unsigned long long b);
+
+#define __even_in_range(value, range) (value)
+
+
+/*
+ * The DMA addresses hold host pointers.
+ */
+#define DMA_WRITE_ADDRESS(reg, address) \
+    ((reg) = (uintptr_t)(address))
+
+
+/*
+ * The flash of the store (flashStore.h) is an array,
+ * programmed or erased as FCTL1 says.
+ */
+#define SIM_FLASH_SEGMENT 512
+#define SIM_FLASH_SIZE    (4 * SIM_FLASH_SEGMENT)
+
+extern unsigned char simFlash[SIM_FLASH_SIZE];
+
+void simFlashWrite(volatile void* address, unsigned short value);
+
+#define FLASH_STORE_BASE ((unsigned char*)simFlash)
+
+#define FLASH_WRITE_WORD(address, value) \
+    simFlashWrite((address), (value))
+
+
+#define SIM_B(name) extern volatile unsigned char  name;
+#define SIM_W(name) extern volatile unsigned short name;
+#define SIM_P(name) extern volatile uintptr_t      name;
+#include "simRegisters.def"
+#undef SIM_B
+#undef SIM_W
+#undef SIM_P
+
+
+#define BIT0 0x0001
+#define BIT1 0x0002
+#define BIT2 0x0004
+#define BIT3 0x0008
+#define BIT4 0x0010
+#define BIT5 0x0020
+#define BIT6 0x0040
+#define BIT7 0x0080
+#define BIT8 0x0100
+#define BIT9 0x0200
+#define BITA 0x0400
+#define BITB 0x0800
+#define BITC 0x1000
+#define BITD 0x2000
+#define BITE 0x4000
+#define BITF 0x8000
+#define GIE 0x0008
+#define CPUOFF 0x0010
+#define OSCOFF 0x0020
+#define SCG0 0x0040
+#define SCG1 0x0080
+#define LPM0_bits (CPUOFF)
+#define LPM1_bits (SCG0+CPUOFF)
+#define LPM2_bits (SCG1+CPUOFF)
+#define LPM3_bits (SCG1+SCG0+CPUOFF)
+#define LPM4_bits (SCG1+SCG0+OSCOFF+CPUOFF)
+#define WDTPW 0x5A00
+#define WDTHOLD 0x0080
+#define TASSEL_0 0x0000
+#define TASSEL_1 0x0100
+#define TASSEL_2 0x0200
+#define TASSEL_3 0x0300
+#define ID_0 0x0000
+#define ID_1 0x0040
+#define ID_2 0x0080
+#define ID_3 0x00C0
+#define MC_0 0x0000
+#define MC_1 0x0010
+#define MC_2 0x0020
+#define MC_3 0x0030
+#define TACLR 0x0004
+#define TAIE 0x0002
+#define TAIFG 0x0001
+#define TBSSEL_1 0x0100
+#define TBSSEL_2 0x0200
+#define TBCLR 0x0004
+#define TBIE 0x0002
+#define TBIFG 0x0001
+#define CM_0 0x0000
+#define CAP 0x0100
+#define OUTMOD_0 0x0000
+#define OUTMOD_3 0x0060
+#define OUTMOD_7 0x00E0
+#define CCIE 0x0010
+#define OUT 0x0004
+#define COV 0x0002
+#define CCIFG 0x0001
+#define TA0IV_TA0CCR1 0x0002
+#define TA0IV_TA0CCR2 0x0004
+#define TA0IV_TA0IFG 0x000E
+#define TA1IV_TA1CCR1 0x0002
+#define TA1IV_TA1CCR2 0x0004
+#define TA1IV_TA1IFG 0x000E
+#define TA2IV_TA2CCR1 0x0002
+#define TA2IV_TA2CCR2 0x0004
+#define TA2IV_TA2IFG 0x000E
+#define TB0IV_TB0CCR1 0x0002
+#define TB0IV_TB0IFG 0x000E
+#define UCSWRST 0x01
+#define UCSSEL_0 0x00
+#define UCSSEL_1 0x40
+#define UCSSEL_2 0x80
+#define UCSSEL_3 0xC0
+#define UCRXEIE 0x20
+#define UCBRKIE 0x10
+#define UCTR 0x10
+#define UCTXNACK 0x08
+#define UCTXSTP 0x04
+#define UCTXSTT 0x02
+#define UCA10 0x80
+#define UCSLA10 0x40
+#define UCMM 0x20
+#define UCMST 0x08
+#define UCMODE_0 0x00
+#define UCMODE_1 0x02
+#define UCMODE_2 0x04
+#define UCMODE_3 0x06
+#define UCSYNC 0x01
+#define UCCKPH 0x80
+#define UCCKPL 0x40
+#define UCMSB 0x20
+#define UC7BIT 0x10
+#define UCBRF_0 0x00
+#define UCBRS_0 0x00
+#define UCBRS_1 0x02
+#define UCBRS_2 0x04
+#define UCBRS_3 0x06
+#define UCBRS_4 0x08
+#define UCBRS_5 0x0A
+#define UCBRS_6 0x0C
+#define UCBRS_7 0x0E
+#define UCOS16 0x01
+#define UCFE 0x40
+#define UCOE 0x20
+#define UCPE 0x10
+#define UCBRK 0x08
+#define UCRXERR 0x04
+#define UCBUSY 0x01
+#define UCBBUSY 0x10
+#define UCNACKIE 0x20
+#define UCALIE 0x10
+#define UCSTPIE 0x08
+#define UCSTTIE 0x04
+#define UCTXIE 0x02
+#define UCRXIE 0x01
+#define UCNACKIFG 0x20
+#define UCALIFG 0x10
+#define UCSTPIFG 0x08
+#define UCSTTIFG 0x04
+#define UCTXIFG 0x02
+#define UCRXIFG 0x01
+#define USCI_NONE 0x0000
+#define USCI_UCRXIFG 0x0002
+#define USCI_UCTXIFG 0x0004
+#define USCI_I2C_UCALIFG 0x0002
+#define USCI_I2C_UCNACKIFG 0x0004
+#define USCI_I2C_UCSTTIFG 0x0006
+#define USCI_I2C_UCSTPIFG 0x0008
+#define USCI_I2C_UCRXIFG 0x000A
+#define USCI_I2C_UCTXIFG 0x000C
+#define ADC12SHT0_8 0x0800
+#define ADC12ON 0x0010
+#define ADC12ENC 0x0002
+#define ADC12SC 0x0001
+#define ADC12SHP 0x0200
+#define ADC12CONSEQ_0 0x0000
+#define ADC12BUSY 0x0001
+#define ADC12INCH_10 0x000A
+#define ADC12IE0 0x0001
+#define ADC12IFG0 0x0001
+#define ADC12IV_ADC12IFG0 0x0006
+#define REFON 0x0001
+#define DMADT_0 0x0000
+#define DMADT_1 0x1000
+#define DMADSTINCR_0 0x0000
+#define DMADSTINCR_3 0x0C00
+#define DMASRCINCR_0 0x0000
+#define DMASRCINCR_3 0x0300
+#define DMADSTBYTE 0x0080
+#define DMASRCBYTE 0x0040
+#define DMALEVEL 0x0020
+#define DMAEN 0x0010
+#define DMAIFG 0x0008
+#define DMAIE 0x0004
+#define DMAABORT 0x0002
+#define DMAREQ 0x0001
+#define DMAIV_DMA0IFG 0x0002
+#define DMAIV_DMA1IFG 0x0004
+#define DMAIV_DMA2IFG 0x0006
+#define DMA0TSEL_0 0x0000
+#define DMARMWDIS 0x0004
+#define FWKEY 0xA500
+#define ERASE 0x0002
+#define MERAS 0x0004
+#define WRT 0x0040
+#define BLKWRT 0x0080
+#define LOCK 0x0010
+#define LOCKA 0x0040
+#define WAIT 0x0008
+#define BUSY 0x0001
+
+
+/*
+ * Interrupt vectors, as numbered by IAR.
+ */
+#define SIM_VECTORS             64
+
+#define RTC_VECTOR       (41 * 2u)
+#define PORT2_VECTOR     (42 * 2u)
+#define TIMER2_A1_VECTOR (43 * 2u)
+#define TIMER2_A0_VECTOR (44 * 2u)
+#define USCI_B1_VECTOR   (45 * 2u)
+#define USCI_A1_VECTOR   (46 * 2u)
+#define PORT1_VECTOR     (47 * 2u)
+#define TIMER1_A1_VECTOR (48 * 2u)
+#define TIMER1_A0_VECTOR (49 * 2u)
+#define DMA_VECTOR       (50 * 2u)
+#define USB_UBM_VECTOR   (51 * 2u)
+#define TIMER0_A1_VECTOR (52 * 2u)
+#define TIMER0_A0_VECTOR (53 * 2u)
+#define ADC12_VECTOR     (54 * 2u)
+#define USCI_B0_VECTOR   (55 * 2u)
+#define USCI_A0_VECTOR   (56 * 2u)
+#define WDT_VECTOR       (57 * 2u)
+#define TIMER0_B1_VECTOR (58 * 2u)
+#define TIMER0_B0_VECTOR (59 * 2u)
+#define COMP_B_VECTOR    (60 * 2u)
+#define UNMI_VECTOR      (61 * 2u)
+#define SYSNMI_VECTOR    (62 * 2u)
+#define RESET_VECTOR     (63 * 2u)
+
+
+#endif // !HOST_IO430F5529_H
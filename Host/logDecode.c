@@ -0,0 +1,269 @@
+/*
+ * Decodes the binary log sent by logDrain (Log/log.h):
+ *
+ *   logdecode firmware.elf < capture.bin
+ *
+ * The format strings are read from the logstr (LOGSTR)
+ * section of the firmware's ELF file, a record's id is
+ * the offset of its string in the section.
+ * Prints a line per record.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "log.h"
+
+
+/**
+ * @brief The type of the sections
+ * without contents in the file.
+ */
+#define SHT_NOBITS 8
+
+
+/**
+ * @brief The format strings section.
+ */
+static const char* _strings = NULL;
+static size_t      _size    = 0;
+
+
+static uint32_t _read(const unsigned char* data, size_t offset, int bytes)
+{
+    uint32_t value = 0;
+
+    while (bytes-- > 0)
+        value = (value << 8) | data[offset + bytes];
+
+    return value;
+}
+
+
+/**
+ * @brief Finds the strings section of a little
+ * endian ELF file, 32 or 64 bits.
+ */
+static int _loadStrings(const unsigned char* elf, size_t length)
+{
+    int      is64;
+    size_t   shoff, shentsize, shnum, shstrndx, names, i;
+
+    if (length < 0x40 || memcmp(elf, "\177ELF", 4) != 0 || elf[5] != 1)
+        return 0;
+
+    is64 = (elf[4] == 2);
+
+    shoff     = is64 ? _read(elf, 0x28, 4) : _read(elf, 0x20, 4);
+    shentsize = _read(elf, is64 ? 0x3A : 0x2E, 2);
+    shnum     = _read(elf, is64 ? 0x3C : 0x30, 2);
+    shstrndx  = _read(elf, is64 ? 0x3E : 0x32, 2);
+
+    if (shoff + shnum * shentsize > length || shstrndx >= shnum)
+        return 0;
+
+    #define SECTION(n) (shoff + (n) * shentsize)
+    #define OFFSET(n)  _read(elf, SECTION(n) + (is64 ? 0x18 : 0x10), 4)
+    #define SIZE(n)    _read(elf, SECTION(n) + (is64 ? 0x20 : 0x14), 4)
+    #define TYPE(n)    _read(elf, SECTION(n) + 4, 4)
+
+    names = OFFSET(shstrndx);
+
+    for (i = 0; i < shnum; i++)
+    {
+        const char* name = (const char*)elf + names + _read(elf, SECTION(i), 4);
+
+        if (strcmp(name, "logstr") == 0 || strcmp(name, "LOGSTR") == 0)
+        {
+            // A NOLOAD section has no bytes in the file:
+            // it must be linked as INFO or COPY
+            if (TYPE(i) == SHT_NOBITS)
+            {
+                fprintf(stderr, "the %s section has no contents\n", name);
+                return 0;
+            }
+
+            if (OFFSET(i) + SIZE(i) > length)
+                return 0;
+
+            _strings = (const char*)elf + OFFSET(i);
+            _size    = SIZE(i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Prints a format with the words of a record:
+ * a word per conversion, two for %l.
+ */
+static void _print(const char* format, const unsigned int* args, int argc)
+{
+    char spec[16];
+    int  arg = 0;
+
+    while (*format != '\0')
+    {
+        size_t length = 1;
+        int    isLong = 0;
+        char   conversion;
+
+        if (*format != '%')
+        {
+            putchar(*format++);
+            continue;
+        }
+
+        if (format[1] == '%')
+        {
+            putchar('%');
+            format += 2;
+            continue;
+        }
+
+        // Flags, width and precision
+        spec[0] = '%';
+        while (strchr("-+ #0123456789.", format[length]) != NULL &&
+               format[length] != '\0' && length < sizeof(spec) - 3)
+        {
+            spec[length] = format[length];
+            length++;
+        }
+
+        conversion = format[length];
+
+        if (conversion == 'l')
+        {
+            isLong     = 1;
+            conversion = format[++length];
+        }
+
+        format += length + (conversion != '\0');
+
+        if (arg + isLong >= argc)
+        {
+            fputs("?", stdout);
+            continue;
+        }
+
+        // Always printed as long
+        spec[length - isLong]     = 'l';
+        spec[length - isLong + 1] = conversion;
+        spec[length - isLong + 2] = '\0';
+
+        {
+            unsigned long value = args[arg++];
+
+            if (isLong)
+                value |= (unsigned long)args[arg++] << 16;
+
+            switch (conversion)
+            {
+                case 'd':
+                case 'i':
+                    printf(spec, isLong
+                        ? (long)(int32_t)value
+                        : (long)(int16_t)value);
+                    break;
+
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o':
+                    printf(spec, value);
+                    break;
+
+                case 'c':
+                    putchar((int)value);
+                    break;
+
+                default:
+                    fputs("?", stdout);
+                    break;
+            }
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    FILE*          file;
+    unsigned char* elf;
+    long           length;
+    int            data;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s firmware.elf < log\n", argv[0]);
+        return 2;
+    }
+
+    file = fopen(argv[1], "rb");
+    if (file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    rewind(file);
+
+    elf = malloc(length);
+    if (elf == NULL || fread(elf, 1, length, file) != (size_t)length ||
+        !_loadStrings(elf, length))
+    {
+        fprintf(stderr, "%s: no log strings section\n", argv[1]);
+        return 1;
+    }
+
+    fclose(file);
+
+    // Records start with LOG_SYNC: anything
+    // else is skipped
+    while ((data = getchar()) != EOF)
+    {
+        unsigned int id, count, i;
+        unsigned int args[LOG_MAX_ARGS];
+        int low, high;
+
+        if (data != LOG_SYNC)
+            continue;
+
+        low   = getchar();
+        high  = getchar();
+        count = getchar();
+
+        if (high == EOF || (int)count == EOF)
+            break;
+
+        id = low | (high << 8);
+
+        if (id >= _size || count > LOG_MAX_ARGS)
+            continue;
+
+        for (i = 0; i < count; i++)
+        {
+            low  = getchar();
+            high = getchar();
+            args[i] = low | (high << 8);
+        }
+
+        if (high == EOF)
+            break;
+
+        _print(_strings + id, args, count);
+
+        if (_strings[id] == '\0' ||
+            _strings[id + strlen(_strings + id) - 1] != '\n')
+            putchar('\n');
+    }
+
+    return 0;
+}
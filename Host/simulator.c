@@ -0,0 +1,418 @@
+#ifndef SIMULATOR_C
+#define SIMULATOR_C
+
+#include "simulator.h"
+#include <string.h>
+
+
+#define SIM_B(name) volatile unsigned char  name;
+#define SIM_W(name) volatile unsigned short name;
+#define SIM_P(name) volatile uintptr_t      name;
+#include "simRegisters.def"
+#undef SIM_B
+#undef SIM_W
+#undef SIM_P
+
+
+/**
+ * @brief The library's interrupt routines, 
+ * NULL when their module isn't linked.
+ */
+#define SIM_ISR(name) extern void name(void) __attribute__((weak));
+SIM_ISR(__serial_interrupt)
+SIM_ISR(__checkTimersCallback)
+SIM_ISR(__adc12_interrupt)
+SIM_ISR(__i2c_interrupt)
+SIM_ISR(__dma_interrupt)
+SIM_ISR(__port1_edge_interrupt)
+SIM_ISR(__port2_edge_interrupt)
+SIM_ISR(__edge_debounce_interrupt)
+SIM_ISR(__mux_seven_seg_interrupt)
+SIM_ISR(__mux_seven_seg_blank_interrupt)
+SIM_ISR(__modbus_interrupt)
+#undef SIM_ISR
+
+
+/**
+ * @brief Written in a transmit buffer before its 
+ * interrupt, to tell whether it was written.
+ */
+#define SIM_EMPTY_TXBUF 0xFFFF
+
+
+void (*simIdleHook)(unsigned short lpmBits) = NULL;
+
+unsigned char simFlash[SIM_FLASH_SIZE];
+
+/**
+ * @brief The flash starts erased,
+ * then it survives the resets.
+ */
+static bool _flashErased = false;
+
+static SimIsr _vectors[SIM_VECTORS];
+static bool   _pending[SIM_VECTORS];
+
+static unsigned short _sr = 0;
+
+/**
+ * @brief The bits cleared by the running interrupt
+ * in the status register it returns to.
+ */
+static unsigned short _exitClear = 0;
+
+
+static void _dispatch(unsigned int index);
+static void _deliverPending(void);
+
+
+void simReset(void)
+{
+    #define SIM_B(name) name = 0;
+    #define SIM_W(name) name = 0;
+    #define SIM_P(name) name = 0;
+    #include "simRegisters.def"
+    #undef SIM_B
+    #undef SIM_W
+    #undef SIM_P
+    
+    // Flash locked
+    FCTL3 = LOCK;
+
+    if (!_flashErased)
+        simFlashErase();
+
+    // Empty transmit buffers
+    UCA1IFG = UCTXIFG;
+    UCB0IFG = UCTXIFG;
+    UCB1IFG = UCTXIFG;
+    
+    memset(_vectors, 0, sizeof(_vectors));
+    memset(_pending, 0, sizeof(_pending));
+    _sr        = 0;
+    _exitClear = 0;
+    
+    if (__serial_interrupt)              simAttach(USCI_A1_VECTOR,   __serial_interrupt);
+    if (__checkTimersCallback)           simAttach(TIMER0_A1_VECTOR, __checkTimersCallback);
+    if (__adc12_interrupt)               simAttach(ADC12_VECTOR,     __adc12_interrupt);
+    if (__i2c_interrupt)                 simAttach(USCI_B0_VECTOR,   __i2c_interrupt);
+    if (__dma_interrupt)                 simAttach(DMA_VECTOR,       __dma_interrupt);
+    if (__port1_edge_interrupt)          simAttach(PORT1_VECTOR,     __port1_edge_interrupt);
+    if (__port2_edge_interrupt)          simAttach(PORT2_VECTOR,     __port2_edge_interrupt);
+    if (__edge_debounce_interrupt)       simAttach(TIMER0_B0_VECTOR, __edge_debounce_interrupt);
+    if (__mux_seven_seg_interrupt)       simAttach(TIMER1_A0_VECTOR, __mux_seven_seg_interrupt);
+    if (__mux_seven_seg_blank_interrupt) simAttach(TIMER1_A1_VECTOR, __mux_seven_seg_blank_interrupt);
+    if (__modbus_interrupt)              simAttach(TIMER2_A1_VECTOR, __modbus_interrupt);
+}
+
+
+void simFlashErase(void)
+{
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    _flashErased = true;
+}
+
+
+void simFlashWrite(volatile void* address, unsigned short value)
+{
+    size_t offset = (volatile unsigned char*)address - simFlash;
+    
+    // An access violation on the device
+    if ((FCTL3 & LOCK) || offset >= SIM_FLASH_SIZE)
+        return;
+    
+    if (FCTL1 & ERASE)
+        memset(&simFlash[offset - offset % SIM_FLASH_SEGMENT], 0xFF, SIM_FLASH_SEGMENT);
+    
+    // Programming only clears bits
+    else if (FCTL1 & WRT)
+    {
+        simFlash[offset]     &= (unsigned char)value;
+        simFlash[offset + 1] &= (unsigned char)(value >> 8);
+    }
+}
+
+
+void simAttach(unsigned int vector, SimIsr isr)
+{
+    _vectors[vector / 2] = isr;
+}
+
+
+bool simRaise(unsigned int vector)
+{
+    unsigned int index = vector / 2;
+    
+    if (_vectors[index] == NULL)
+        return false;
+    
+    if (_sr & GIE)
+        _dispatch(index);
+    
+    else
+        _pending[index] = true;
+    
+    return true;
+}
+
+
+unsigned short simStatusRegister(void)
+{
+    return _sr;
+}
+
+
+void simSerialReceive(byte data)
+{
+    UCA1RXBUF = data;
+    UCA1IFG  |= UCRXIFG;
+    
+    if (UCA1IE & UCRXIE)
+        simRaise(USCI_A1_VECTOR);
+    
+    // Cleared by reading UCA1RXBUF
+    UCA1IFG &= ~UCRXIFG;
+}
+
+
+int simSerialTransmit(void)
+{
+    if (!(UCA1IE & UCTXIE) || !(UCA1IFG & UCTXIFG))
+        return SIM_NO_DATA;
+    
+    UCA1TXBUF = SIM_EMPTY_TXBUF;
+    simRaise(USCI_A1_VECTOR);
+    
+    // Sent at once: UCTXIFG stays set
+    return UCA1TXBUF == SIM_EMPTY_TXBUF ? SIM_NO_DATA : UCA1TXBUF;
+}
+
+
+void simTimerTick(void)
+{
+    if (!(TA0CTL & MC_3))
+        return;
+    
+    TA0CTL |= TAIFG;
+    
+    if (TA0CTL & TAIE)
+        simRaise(TIMER0_A1_VECTOR);
+}
+
+
+bool simAdc12Complete(unsigned int value)
+{
+    if (!(ADC12CTL0 & ADC12SC))
+        return false;
+    
+    ADC12CTL0 &= ~ADC12SC;
+    ADC12CTL1 &= ~ADC12BUSY;
+    ADC12MEM0  = value;
+    ADC12IFG  |= ADC12IFG0;
+    
+    if (ADC12IE & ADC12IE0)
+        simRaise(ADC12_VECTOR);
+    
+    return true;
+}
+
+
+void simPortWrite(byte port, byte pins, bool high)
+{
+    volatile unsigned char *in, *ies, *ie, *ifg;
+    byte edges;
+    
+    switch (port)
+    {
+        case 1: in = &P1IN; ies = &P1IES; ie = &P1IE; ifg = &P1IFG; break;
+        case 2: in = &P2IN; ies = &P2IES; ie = &P2IE; ifg = &P2IFG; break;
+        default: return;
+    }
+    
+    // The pins that change, high-to-low 
+    // edges matching IES = 1
+    edges = (high ? ~*in : *in) & pins;
+    edges &= high ? ~*ies : *ies;
+    
+    if (high) *in |=  pins;
+    else      *in &= ~pins;
+    
+    *ifg |= edges;
+    
+    if (*ifg & *ie)
+        simRaise(port == 1 ? PORT1_VECTOR : PORT2_VECTOR);
+}
+
+
+int simI2cEvent(unsigned int iv, byte received)
+{
+    if (iv == USCI_I2C_UCRXIFG)
+        UCB0RXBUF = received;
+    
+    UCB0IV    = iv;
+    UCB0TXBUF = SIM_EMPTY_TXBUF;
+    
+    simRaise(USCI_B0_VECTOR);
+    UCB0IV = USCI_NONE;
+    
+    return UCB0TXBUF == SIM_EMPTY_TXBUF ? SIM_NO_DATA : UCB0TXBUF;
+}
+
+
+/**
+ * @brief Runs an interrupt like the CPU: the status 
+ * register is saved, the interrupts are disabled and 
+ * the CPU is active until the routine returns.
+ */
+static void _dispatch(unsigned int index)
+{
+    unsigned short saved     = _sr;
+    unsigned short exitClear = _exitClear;
+    
+    _pending[index] = false;
+    _sr        = 0;
+    _exitClear = 0;
+    
+    _vectors[index]();
+    
+    _sr        = saved & ~_exitClear;
+    _exitClear = exitClear;
+}
+
+
+static void _deliverPending(void)
+{
+    unsigned int i;
+    
+    // Higher vectors have the higher priority
+    for (i = SIM_VECTORS - 1; i > 0 && (_sr & GIE); i--)
+        if (_pending[i])
+            _dispatch(i);
+}
+
+
+void __enable_interrupt(void)
+{
+    _sr |= GIE;
+    _deliverPending();
+}
+
+
+void __disable_interrupt(void)
+{
+    _sr &= ~GIE;
+}
+
+
+__istate_t __get_interrupt_state(void)
+{
+    return _sr & GIE;
+}
+
+
+void __set_interrupt_state(__istate_t state)
+{
+    _sr = (_sr & ~GIE) | (state & GIE);
+    _deliverPending();
+}
+
+
+void __bis_SR_register(unsigned short bits)
+{
+    _sr |= bits;
+    _deliverPending();
+    
+    // Sleeping until an interrupt clears the 
+    // bits, or at once without a hook
+    if ((_sr & LPM4_bits) && simIdleHook != NULL)
+        simIdleHook(_sr & LPM4_bits);
+    
+    _sr &= ~LPM4_bits;
+}
+
+
+void __bic_SR_register(unsigned short bits)
+{
+    _sr &= ~bits;
+}
+
+
+void __bis_SR_register_on_exit(unsigned short bits)
+{
+    _exitClear &= ~bits;
+}
+
+
+void __bic_SR_register_on_exit(unsigned short bits)
+{
+    _exitClear |= bits;
+}
+
+
+void __no_operation(void)
+{
+}
+
+
+void __delay_cycles(unsigned long cycles)
+{
+    (void)cycles;
+}
+
+
+void __data16_write_addr(unsigned short address, unsigned long value)
+{
+    (void)address;
+    (void)value;
+}
+
+
+/**
+ * @brief Adds two packed BCD numbers 
+ * of the given number of digits.
+ */
+static unsigned long long _bcdAdd(
+    unsigned long long a, 
+    unsigned long long b, 
+    byte digits)
+{
+    unsigned long long result = 0;
+    byte carry = 0;
+    byte i;
+    
+    for (i = 0; i < digits; i++)
+    {
+        byte digit = (byte)((a & 0xF) + (b & 0xF) + carry);
+        
+        carry = digit > 9;
+        if (carry)
+            digit -= 10;
+        
+        result |= (unsigned long long)digit << (4 * i);
+        a >>= 4;
+        b >>= 4;
+    }
+    
+    return result;
+}
+
+
+unsigned short __bcd_add_short(unsigned short a, unsigned short b)
+{
+    return (unsigned short)_bcdAdd(a, b, 4);
+}
+
+
+unsigned long __bcd_add_long(unsigned long a, unsigned long b)
+{
+    return (unsigned long)_bcdAdd(a & 0xFFFFFFFFUL, b & 0xFFFFFFFFUL, 8);
+}
+
+
+unsigned long long __bcd_add_long_long(unsigned long long a, unsigned long long b)
+{
+    return _bcdAdd(a, b, 16);
+}
+
+
+#endif // !SIMULATOR_C
@@ -0,0 +1,127 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+/*
+ * Drives the simulated peripherals of the host build:
+ * the test or benchmark plays the part of the hardware 
+ * (a byte received, a timer overflow, a conversion over) 
+ * and the simulator raises the library's interrupts.
+ */
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief Returned by simSerialTransmit 
+ * when nothing was sent.
+ */
+#define SIM_NO_DATA (-1)
+
+
+typedef void (*SimIsr)(void);
+
+
+/**
+ * @brief Called when the library enters a low power 
+ * mode, with the status register bits: the hardware
+ * events that wake it must be simulated here.
+ * Without a hook the CPU wakes immediately.
+ */
+extern void (*simIdleHook)(unsigned short lpmBits);
+
+
+/**
+ * @brief Clears all the registers, sets their reset
+ * values and attaches the library's interrupts
+ * that are linked.
+ */
+void simReset(void);
+
+
+/**
+ * @brief Sets the routine of a vector (xxx_VECTOR).
+ */
+void simAttach(unsigned int vector, SimIsr isr);
+
+
+/**
+ * @brief Raises an interrupt: runs its routine now if 
+ * the interrupts are enabled, when they are enabled 
+ * again otherwise.
+ *
+ * @returns
+ *      False if no routine is attached.
+ */
+bool simRaise(unsigned int vector);
+
+
+/**
+ * @brief The simulated status register 
+ * (GIE and the low power mode bits).
+ */
+unsigned short simStatusRegister(void);
+
+
+/**
+ * @brief Receives a byte on UCA1, raising 
+ * the receive interrupt if enabled.
+ */
+void simSerialReceive(byte data);
+
+
+/**
+ * @brief Lets UCA1 send a byte: raises the transmit 
+ * interrupt if enabled.
+ *
+ * @returns
+ *      The byte written to UCA1TXBUF, 
+ *      SIM_NO_DATA if none.
+ */
+int simSerialTransmit(void);
+
+
+/**
+ * @brief The Timer A0 overflows 
+ * (TAIFG), if running.
+ */
+void simTimerTick(void);
+
+
+/**
+ * @brief Ends a started ADC12 conversion
+ * with the given result.
+ *
+ * @returns
+ *      False if no conversion was started.
+ */
+bool simAdc12Complete(unsigned int value);
+
+
+/**
+ * @brief Changes some pins of the P1 or P2 inputs,
+ * raising the edge interrupts that match PxIES.
+ */
+void simPortWrite(byte port, byte pins, bool high);
+
+
+/**
+ * @brief Raises the USCI_B0 interrupt with the given 
+ * UCB0IV value (USCI_I2C_xxx), setting UCB0RXBUF 
+ * first for a received byte.
+ *
+ * @returns
+ *      The byte written to UCB0TXBUF,
+ *      SIM_NO_DATA if none.
+ */
+int simI2cEvent(unsigned int iv, byte received);
+
+
+/**
+ * @brief Erases the whole simulated flash,
+ * which simReset keeps, as the device does.
+ */
+void simFlashErase(void);
+
+
+#endif // !SIMULATOR_H
@@ -3,35 +3,398 @@
 
 
 #include "io430f5529.h"
+#include "i2c.h"
+#include "power.h"
+#include "trace.h"
+
+
+/**
+ * @brief The running transaction, 
+ * followed by the queued ones.
+ */
+static I2CTransaction* volatile _head = NULL;
+static I2CTransaction* volatile _tail = NULL;
+
+/**
+ * @brief The next byte to write or 
+ * to read of the running transaction.
+ */
+static uint _index;
+
+
+static void _start(I2CTransaction *transaction);
+static void _startRead(I2CTransaction *transaction);
+static void _complete(I2CStatus status);
+static void _dmaCompleted(void);
+
+
+/**
+ * @brief Tells whether a transfer of the given 
+ * length is moved by the DMA.
+ */
+#define I2C_USE_DMA(length) \
+    (I2C_DMA_THRESHOLD > 0 && (length) >= I2C_DMA_THRESHOLD)
 
 
 /**
  * Initializes I2C mode for the USCI.
  */
-void initI2C(int slaveAddress)
+void initI2C(I2CSpeed speed)
 {
-    // USCI in reset mode
-    UCB0CTL1 |= UCSWRST; 
-
-    UCB0CTL0 |= 
-        UCMST    +      // I2C master
-        UCMODE_3 +      // USCI in I2C mode
-        UCSYNC;         // Synchronous mode
+    // P3.0,1 = USCI_B0 SDA/SCL
+    P3SEL |= BIT0 + BIT1;
+    
+    I2C_RESET
+    (
+        UCB0CTL0 = 
+            UCMST    +      // I2C master
+            UCMODE_3 +      // USCI in I2C mode
+            UCSYNC;         // Synchronous mode
     
-    UCB0I2CSA = slaveAddress;
+        UCB0CTL1 = UCSSEL_2 + UCSWRST; // SMCLK
+        
+        UCB0BR0 = speed;
+        UCB0BR1 = 0;
+    );
     
-    // Disabling reset mode
-    UCB0CTL1 &= ~UCSWRST; 
+    dmaSetCallback(I2C_DMA_CHANNEL, &_dmaCompleted);
     
-    UCB0CTL1 |= 
-        ~UCTR   +       // Receiver mode
-         0;       // Sending a START condition  
+    I2C_ENABLE_IRQ();
+}
+
+
+bool i2cSubmit(I2CTransaction *transaction)
+{
+    if (transaction->status == I2C_PENDING)
+        return false;
+    
+    transaction->status = I2C_PENDING;
+    transaction->_next  = NULL;
+    
+    // With the check of the queue: the transaction
+    // running may end and release the clock
+    ATOMIC
+    (
+        powerRequire(POWER_I2C, POWER_LPM0);
         
-    // UCTXSTT is reset when the slave
-    // acknowledges the START
-    while (UCB0CTL1 & UCTXSTT)
+        if (_head == NULL)
+        {
+            _head = _tail = transaction;
+            _start(transaction);
+        }
+        else
+        {
+            _tail->_next = transaction;
+            _tail = transaction;
+        }
+    );
+    
+    return true;
+}
+
+
+bool i2cWrite(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *data,
+    uint            length,
+    I2CCallback     completed)
+{
+    return i2cWriteRead(
+        transaction, address, 
+        data, length, 
+        NULL, 0, 
+        completed);
+}
+
+
+bool i2cRead(
+    I2CTransaction *transaction,
+    byte            address,
+    byte           *data,
+    uint            length,
+    I2CCallback     completed)
+{
+    return i2cWriteRead(
+        transaction, address, 
+        NULL, 0, 
+        data, length, 
+        completed);
+}
+
+
+bool i2cWriteRead(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *txData,
+    uint            txLength,
+    byte           *rxData,
+    uint            rxLength,
+    I2CCallback     completed)
+{
+    if (transaction->status == I2C_PENDING)
+        return false;
+    
+    transaction->address   = address;
+    transaction->txData    = txData;
+    transaction->txLength  = txLength;
+    transaction->rxData    = rxData;
+    transaction->rxLength  = rxLength;
+    transaction->rxRing    = NULL;
+    transaction->completed = completed;
+    
+    return i2cSubmit(transaction);
+}
+
+
+bool i2cWriteReadRing(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *txData,
+    uint            txLength,
+    CircularBuffer *ring,
+    uint            rxLength,
+    I2CCallback     completed)
+{
+    byte* space;
+    
+    if (transaction->status == I2C_PENDING ||
+        cbWriteSpace(ring, &space) < rxLength)
+        return false;
+    
+    transaction->address   = address;
+    transaction->txData    = txData;
+    transaction->txLength  = txLength;
+    transaction->rxData    = space;
+    transaction->rxLength  = rxLength;
+    transaction->rxRing    = ring;
+    transaction->completed = completed;
+    
+    return i2cSubmit(transaction);
+}
+
+
+I2CStatus i2cWait(I2CTransaction *transaction)
+{
+    // Woken by the end of the transactions
+    while (transaction->status == I2C_PENDING)
+        powerIdle();
+    
+    return transaction->status;
+}
+
+
+inline bool i2cIsBusy(void)
+{
+    return _head != NULL;
+}
+
+
+/**
+ * @brief Sends the START of a transaction,
+ * in transmitter mode unless it only reads.
+ */
+static void _start(I2CTransaction *transaction)
+{
+    // The STOP of the previous 
+    // transaction is still being sent
+    while (UCB0CTL1 & UCTXSTP)
         ;
+    
+    UCB0I2CSA = transaction->address;
+    _index = 0;
+    
+    if (transaction->txLength == 0 && transaction->rxLength > 0)
+    {
+        _startRead(transaction);
+        return;
+    }
+    
+    // The DMA is armed before the START, 
+    // it only sees the rising edges of UCTXIFG
+    if (I2C_USE_DMA(transaction->txLength))
+    {
+        UCB0IE  &= ~UCTXIE;
+        UCB0IFG &= ~UCTXIFG;
+        
+        dmaSetTrigger(I2C_DMA_CHANNEL, DMA_TRIGGER_UCB0_TX);
+        DMA_START(
+            I2C_DMA_CHANNEL, 
+            transaction->txData, 
+            &UCB0TXBUF, 
+            transaction->txLength,
+            DMASRCINCR_3 + DMADSTINCR_0);
+    }
+    
+    UCB0CTL1 |= UCTR + UCTXSTT;
+}
+
+
+/**
+ * @brief Sends a (repeated) START 
+ * in receiver mode.
+ */
+static void _startRead(I2CTransaction *transaction)
+{
+    _index = 0;
+    
+    // All the bytes but the last one: the STOP 
+    // is sent while the last one is received
+    if (I2C_USE_DMA(transaction->rxLength))
+    {
+        UCB0IE  &= ~UCRXIE;
+        UCB0IFG &= ~UCRXIFG;
+        
+        dmaSetTrigger(I2C_DMA_CHANNEL, DMA_TRIGGER_UCB0_RX);
+        DMA_START(
+            I2C_DMA_CHANNEL, 
+            &UCB0RXBUF, 
+            transaction->rxData, 
+            transaction->rxLength - 1,
+            DMASRCINCR_0 + DMADSTINCR_3);
+    }
+    
+    UCB0CTL1 &= ~UCTR;
+    UCB0CTL1 |=  UCTXSTT;
+    
+    // A single byte needs the STOP as soon 
+    // as the address has been acknowledged
+    if (transaction->rxLength == 1)
+    {
+        while (UCB0CTL1 & UCTXSTT)
+            ;
+        
+        UCB0CTL1 |= UCTXSTP;
+    }
+}
+
+
+/**
+ * @brief Ends the running transaction and 
+ * starts the next one.
+ */
+static void _complete(I2CStatus status)
+{
+    I2CTransaction* transaction = _head;
+    I2CTransaction* next        = transaction->_next;
+    
+    // An error can stop a DMA transfer
+    DMA_STOP(I2C_DMA_CHANNEL);
+    UCB0IE |= UCTXIE + UCRXIE;
+    
+    _head = next;
+    if (_head == NULL) 
+        _tail = NULL;
+    
+    if (status == I2C_DONE && transaction->rxRing != NULL)
+        cbWriteCommit(transaction->rxRing, transaction->rxLength);
+    
+    transaction->status = status;
+    
+    if (transaction->completed != NULL)
+        transaction->completed(transaction);
+    
+    POWER_POST_WORK();
+    
+    // A transaction submitted by the callback 
+    // to an empty queue has already started
+    if (next != NULL)
+        _start(next);
+    
+    else if (_head == NULL)
+        powerRelease(POWER_I2C);
+}
+
+
+/**
+ * @brief Called when the DMA has moved all the
+ * bytes of a write, or all but one of a read:
+ * the USCI interrupt ends the transfer.
+ */
+static void _dmaCompleted(void)
+{
+    if (UCB0CTL1 & UCTR)
+    {
+        // The next UCTXIFG comes when the
+        // last byte is being sent
+        _index = _head->txLength;
+        UCB0IE |= UCTXIE;
+    }
+    else
+    {
+        _index = _head->rxLength - 1;
+        UCB0CTL1 |= UCTXSTP;
+        UCB0IE   |= UCRXIE;
+    }
+}
+
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void __i2c_interrupt(void)
+{
+    register I2CTransaction* transaction = _head;
+    
+    TRACE_ISR_ENTER(TRACE_I2C);
+    
+    // Reading UCB0IV clears the flag
+    switch (__even_in_range(UCB0IV, USCI_I2C_UCTXIFG))
+    {
+        case USCI_I2C_UCALIFG:
+            // Another master won the bus, 
+            // the USCI became a slave
+            UCB0CTL0 |= UCMST;
+            _complete(I2C_ARBITRATION_LOST);
+            break;
+            
+        case USCI_I2C_UCNACKIFG:
+            UCB0CTL1 |= UCTXSTP;
+            _complete(I2C_NACK);
+            break;
+            
+        case USCI_I2C_UCRXIFG:
+            transaction->rxData[_index++] = UCB0RXBUF;
+            
+            // The STOP is sent after the byte 
+            // being received now, the last one
+            if (transaction->rxLength - _index == 1)
+                UCB0CTL1 |= UCTXSTP;
+            
+            else if (_index == transaction->rxLength)
+                _complete(I2C_DONE);
+            break;
+            
+        case USCI_I2C_UCTXIFG:
+            if (_index < transaction->txLength)
+            {
+                UCB0TXBUF = transaction->txData[_index++];
+                break;
+            }
+            
+            if (transaction->rxLength > 0)
+            {
+                _startRead(transaction);
+                break;
+            }
+            
+            // Address only: waiting for the 
+            // slave's ACK or NACK
+            if (transaction->txLength == 0)
+            {
+                while (UCB0CTL1 & UCTXSTT)
+                    ;
+                
+                if (UCB0IFG & UCNACKIFG)
+                    break;
+            }
+            
+            UCB0CTL1 |= UCTXSTP;
+            _complete(I2C_DONE);
+            break;
+    }
+    
+    TRACE_ISR_EXIT(TRACE_I2C);
+    POWER_WAKE_ON_EXIT();
 }
 
 
-#endif // !I2C_C
\ No newline at end of file
+#endif // !I2C_C
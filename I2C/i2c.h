@@ -1,11 +1,230 @@
 #ifndef I2C_H
 #define I2C_H
 
+#include "io430f5529.h"
+#include "utility.h"
+#include "circularBuffer.h"
+#include "dma.h"
+
+
+#ifndef I2C_DMA_CHANNEL
+/**
+ * @brief The DMA channel used for 
+ * the I2C bursts.
+ */
+#define I2C_DMA_CHANNEL 0
+#endif // !I2C_DMA_CHANNEL
+
+
+#ifndef I2C_DMA_THRESHOLD
+/**
+ * @brief The writes and reads of at least this
+ * many bytes are moved by the DMA, with two 
+ * interrupts per transfer instead of one per byte.
+ * 0 never uses the DMA.
+ */
+#define I2C_DMA_THRESHOLD 4
+#endif // !I2C_DMA_THRESHOLD
+
+
+/**
+ * @brief 
+ * The USCI_B0 prescaler (UCBR) for the 
+ * I2C clock, with SMCLK at 1.048 MHz.
+ */
+typedef enum I2CSpeed
+{
+    I2C_100KHZ = 11,
+    I2C_400KHZ = 3
+} I2CSpeed;
+
+
+/**
+ * @brief 
+ * The state of a transaction.
+ */
+typedef enum I2CStatus
+{
+    I2C_DONE = 0x00,
+    I2C_PENDING,
+    I2C_NACK,
+    I2C_ARBITRATION_LOST
+} I2CStatus;
+
+
+struct I2CTransaction;
+
+typedef void (*I2CCallback)(struct I2CTransaction* transaction);
+
+
+/**
+ * @brief 
+ * A transfer with a slave: txLength bytes are written, 
+ * then rxLength bytes are read after a repeated start.
+ * Either can be empty; with both empty only the 
+ * address is sent, to check if the slave answers.
+ *
+ * The struct and its buffers are owned by the driver
+ * until the status is no longer I2C_PENDING.
+ * Must be zero-initialized before the first use.
+ */
+typedef struct I2CTransaction
+{
+    /**
+     * @brief The 7 bits slave address.
+     */
+    byte address;
+    
+    const byte *txData;
+    uint        txLength;
+    
+    byte *rxData;
+    uint  rxLength;
+    
+    /**
+     * @brief 
+     * When not NULL, rxData points to the ring's
+     * free space and the read bytes are added 
+     * to the ring once the transaction is done.
+     */
+    CircularBuffer *rxRing;
+    
+    /**
+     * @brief 
+     * Called from the interrupt when the transaction
+     * is over, whatever the result. Can be NULL.
+     */
+    I2CCallback completed;
+    
+    /**
+     * @brief 
+     * Optional data for the callback.
+     */
+    void *context;
+    
+    volatile I2CStatus status;
+    
+//\
+Private:
+    struct I2CTransaction *_next;
+    
+} I2CTransaction;
+
+
+#define I2C_TX_ENABLED()     (UCB0IE & UCTXIE)
+#define I2C_ENABLE_IRQ()     (UCB0IE |=  (UCNACKIE + UCALIE + UCTXIE + UCRXIE))
+#define I2C_DISABLE_IRQ()    (UCB0IE &= ~(UCNACKIE + UCALIE + UCTXIE + UCRXIE))
+
+
+/**
+ * @brief 
+ * Executes the given code while
+ * the USCI interface is in reset
+ * mode.
+ */
+#define I2C_RESET(expr)         \
+    {                           \
+        UCB0CTL1 |= UCSWRST;    \
+        expr                    \
+        UCB0CTL1 &= ~UCSWRST;   \
+    }
+
+
+/**
+ * Initializes the USCI_B0 as I2C master 
+ * (P3.0 SDA, P3.1 SCL).
+ */
+void initI2C(I2CSpeed speed);
+
+
+/**
+ * @brief 
+ * Queues a transaction, which starts as 
+ * soon as the previous ones are over.
+ *
+ * @returns
+ *      False if the transaction is still pending.
+ */
+bool i2cSubmit(I2CTransaction *transaction);
+
+
+/**
+ * @brief 
+ * Queues a write of the given bytes.
+ */
+bool i2cWrite(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *data,
+    uint            length,
+    I2CCallback     completed);
+
+
+/**
+ * @brief 
+ * Queues a read of the given number of bytes.
+ */
+bool i2cRead(
+    I2CTransaction *transaction,
+    byte            address,
+    byte           *data,
+    uint            length,
+    I2CCallback     completed);
+
+
+/**
+ * @brief 
+ * Queues a write followed by a read with a 
+ * repeated start, usually a register address
+ * and its content.
+ */
+bool i2cWriteRead(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *txData,
+    uint            txLength,
+    byte           *rxData,
+    uint            rxLength,
+    I2CCallback     completed);
+
+
+/**
+ * @brief 
+ * Queues a write followed by a read, like 
+ * i2cWriteRead, that reads in place in the
+ * ring's free space (e.g. a sample queue).
+ * Only a read per ring can be pending.
+ *
+ * @returns
+ *      False if the transaction is still pending
+ *      or the contiguous free space is too small.
+ */
+bool i2cWriteReadRing(
+    I2CTransaction *transaction,
+    byte            address,
+    const byte     *txData,
+    uint            txLength,
+    CircularBuffer *ring,
+    uint            rxLength,
+    I2CCallback     completed);
+
+
+/**
+ * @brief 
+ * Blocks until a transaction is over.
+ *
+ * @returns
+ *      The transaction's result.
+ */
+I2CStatus i2cWait(I2CTransaction *transaction);
+
 
 /**
- * Initializes I2C mode for the USCI.
+ * @brief 
+ * Tells whether there are transactions
+ * running or queued.
  */
-void initI2C(void);
+bool i2cIsBusy(void);
 
 
-#endif // !I2C_H
\ No newline at end of file
+#endif // !I2C_H
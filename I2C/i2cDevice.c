@@ -0,0 +1,237 @@
+#ifndef I2C_DEVICE_C
+#define I2C_DEVICE_C
+
+
+#include "io430f5529.h"
+#include "i2cDevice.h"
+#include "memoryManager.h"
+#include "power.h"
+#include <string.h>
+
+
+#if I2C_DEVICE_MAX_REGISTERS > 32
+#error "The valid and dirty registers are 32 bits masks"
+#endif
+
+
+#define REGISTER_BIT(index) (1UL << (index))
+
+
+static void _flushNext(I2CDevice* device);
+static void _flushed(I2CTransaction* transaction);
+static void _loaded(I2CTransaction* transaction);
+
+
+I2CDevice* createI2CDevice(byte address, byte firstRegister, byte registers)
+{
+    I2CDevice* result = 
+        (I2CDevice*)memAlloc(sizeof(I2CDevice));
+    
+    if (result == NULL) return NULL;
+    
+    // The cache can't hold more
+    if (registers > I2C_DEVICE_MAX_REGISTERS)
+        registers = I2C_DEVICE_MAX_REGISTERS;
+    
+    memset(&result->transaction, 0, sizeof(I2CTransaction));
+    
+    result->address       = address;
+    result->firstRegister = firstRegister;
+    result->registers     = registers;
+    result->status        = I2C_DONE;
+    
+    result->_valid = 0;
+    result->_dirty = 0;
+    
+    return result;
+}
+
+
+bool i2cDeviceLoad(I2CDevice* device)
+{
+    if (I2C_DEVICE_IS_BUSY(device) || device->_dirty != 0)
+        return false;
+    
+    device->status    = I2C_PENDING;
+    device->_burst[0] = device->firstRegister;
+    
+    return i2cWriteRead(
+        &device->transaction, device->address,
+        device->_burst, 1,
+        device->_cache, device->registers,
+        &_loaded);
+}
+
+
+bool i2cDeviceStage(I2CDevice* device, byte reg, byte value)
+{
+    byte  index = reg - device->firstRegister;
+    ulong bit;
+    
+    if (reg < device->firstRegister || index >= device->registers)
+        return false;
+    
+    bit = REGISTER_BIT(index);
+    
+    if ((device->_valid & bit) && device->_cache[index] == value)
+        return false;
+    
+    device->_cache[index] = value;
+    device->_valid |= bit;
+    
+    // The flush clears the bits from the interrupt
+    ATOMIC
+    (
+        device->_dirty |= bit;
+    );
+    
+    return true;
+}
+
+
+void i2cDeviceFlush(I2CDevice* device)
+{
+    // A running flush writes 
+    // the new dirty registers
+    ATOMIC
+    (
+        if (!I2C_DEVICE_IS_BUSY(device) && device->_dirty != 0)
+        {
+            device->status = I2C_PENDING;
+            _flushNext(device);
+        }
+    );
+}
+
+
+void i2cDeviceWrite(I2CDevice* device, byte reg, byte value)
+{
+    if (i2cDeviceStage(device, reg, value))
+        i2cDeviceFlush(device);
+}
+
+
+bool i2cDeviceGet(I2CDevice* device, byte reg, byte* value)
+{
+    byte index = reg - device->firstRegister;
+    
+    if (reg < device->firstRegister || index >= device->registers)
+        return false;
+    
+    if (!(device->_valid & REGISTER_BIT(index)))
+        return false;
+    
+    *value = device->_cache[index];
+    return true;
+}
+
+
+I2CStatus i2cDeviceWait(I2CDevice* device)
+{
+    while (I2C_DEVICE_IS_BUSY(device))
+        powerIdle();
+    
+    return device->status;
+}
+
+
+byte i2cScanBus(byte* found, byte size)
+{
+    I2CTransaction probe;
+    byte address;
+    byte count = 0;
+    
+    memset(&probe, 0, sizeof(I2CTransaction));
+    
+    // Nothing to read or write: START, address, STOP
+    for (address = I2C_SCAN_FIRST; address <= I2C_SCAN_LAST; address++)
+    {
+        i2cWrite(&probe, address, NULL, 0, NULL);
+        
+        if (i2cWait(&probe) != I2C_DONE)
+            continue;
+        
+        if (count < size)
+            found[count] = address;
+        
+        count++;
+    }
+    
+    return count;
+}
+
+
+/**
+ * @brief Writes the first run of dirty registers, 
+ * or ends the flush if there are none.
+ * Called with the interrupts disabled.
+ */
+static void _flushNext(I2CDevice* device)
+{
+    ulong dirty = device->_dirty;
+    byte  start = 0;
+    byte  length;
+    
+    if (dirty == 0)
+    {
+        device->status = I2C_DONE;
+        return;
+    }
+    
+    while (!(dirty & REGISTER_BIT(start)))
+        start++;
+    
+    for (length = 0; 
+         start + length < device->registers && 
+            (dirty & REGISTER_BIT(start + length)); 
+         length++)
+    {
+        device->_burst[length + 1] = device->_cache[start + length];
+        device->_dirty &= ~REGISTER_BIT(start + length);
+    }
+    
+    device->_runStart  = start;
+    device->_runLength = length;
+    device->_burst[0]  = device->firstRegister + start;
+    
+    i2cWrite(
+        &device->transaction, device->address,
+        device->_burst, length + 1,
+        &_flushed);
+}
+
+
+static void _flushed(I2CTransaction* transaction)
+{
+    I2CDevice* device = (I2CDevice*)transaction;
+    byte i;
+    
+    if (transaction->status == I2C_DONE)
+    {
+        _flushNext(device);
+        return;
+    }
+    
+    // The run is written again by the next flush
+    for (i = 0; i < device->_runLength; i++)
+        device->_dirty |= REGISTER_BIT(device->_runStart + i);
+    
+    device->status = transaction->status;
+}
+
+
+static void _loaded(I2CTransaction* transaction)
+{
+    I2CDevice* device = (I2CDevice*)transaction;
+    
+    if (transaction->status == I2C_DONE)
+        device->_valid = 
+            device->registers < 32 
+                ? REGISTER_BIT(device->registers) - 1 
+                : ~0UL;
+    
+    device->status = transaction->status;
+}
+
+
+#endif // !I2C_DEVICE_C
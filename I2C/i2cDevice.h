@@ -0,0 +1,196 @@
+#ifndef I2C_DEVICE_H
+#define I2C_DEVICE_H
+
+#include "utility.h"
+#include "i2c.h"
+
+
+#ifndef I2C_DEVICE_MAX_REGISTERS
+/**
+ * @brief The maximum number of cached 
+ * registers of a device, up to 32.
+ */
+#define I2C_DEVICE_MAX_REGISTERS 32
+#endif // !I2C_DEVICE_MAX_REGISTERS
+
+
+/**
+ * @brief The range of the 7 bits addresses
+ * probed by the bus scan, reserved ones excluded.
+ */
+#define I2C_SCAN_FIRST 0x08
+#define I2C_SCAN_LAST  0x77
+
+
+/**
+ * @brief 
+ * A slave with consecutive 8 bits registers 
+ * (e.g. configuration registers) whose values 
+ * are cached.
+ *
+ * Writes only update the cache and mark the 
+ * registers as dirty if their value changes;
+ * a flush writes each run of contiguous dirty 
+ * registers with a single burst, using the 
+ * register address auto-increment.
+ */
+typedef struct I2CDevice
+{
+    /**
+     * @brief 
+     * Used for all the device's transfers.
+     * Must be the first member: the callbacks
+     * get the device from it.
+     */
+    I2CTransaction transaction;
+    
+    /**
+     * @brief The 7 bits slave address.
+     */
+    byte address;
+    
+    /**
+     * @brief The address of the first cached 
+     * register and the number of registers.
+     */
+    byte firstRegister;
+    byte registers;
+    
+    /**
+     * @brief 
+     * The result of the last flush or load,
+     * I2C_PENDING while running.
+     */
+    volatile I2CStatus status;
+    
+//\
+Private:
+    byte _cache[I2C_DEVICE_MAX_REGISTERS];
+    
+    /**
+     * @brief A bit per register: its cached 
+     * value is known / must be written.
+     */
+    ulong          _valid;
+    volatile ulong _dirty;
+    
+    /**
+     * @brief The run of registers being written:
+     * register address followed by the values.
+     */
+    byte _runStart;
+    byte _runLength;
+    byte _burst[I2C_DEVICE_MAX_REGISTERS + 1];
+    
+} I2CDevice;
+
+
+/**
+ * @brief 
+ * Allocates an I2CDevice structure and returns
+ * a pointer to it, NULL if out of memory. 
+ * No register is known until loaded or written.
+ *
+ * @param registers
+ *      The number of cached registers, 
+ *      up to I2C_DEVICE_MAX_REGISTERS:
+ *      the ones beyond aren't cached.
+ */
+I2CDevice* createI2CDevice(byte address, byte firstRegister, byte registers);
+
+
+/**
+ * @brief 
+ * Reads all the cached registers with a single 
+ * burst. Registers must not be written while 
+ * loading.
+ *
+ * @returns
+ *      False if the device is busy or has 
+ *      registers waiting to be flushed.
+ */
+bool i2cDeviceLoad(I2CDevice* device);
+
+
+/**
+ * @brief 
+ * Changes the cached value of a register, 
+ * which is written by the next flush.
+ *
+ * @returns
+ *      True if the register must be written,
+ *      false if the device already has the value
+ *      or the register isn't cached.
+ */
+bool i2cDeviceStage(I2CDevice* device, byte reg, byte value);
+
+
+/**
+ * @brief 
+ * Writes all the registers changed since the 
+ * last flush, a burst per contiguous run.
+ * The registers changed while flushing are 
+ * written by the same flush.
+ */
+void i2cDeviceFlush(I2CDevice* device);
+
+
+/**
+ * @brief 
+ * Writes a register through the cache: 
+ * nothing is sent if the value is unchanged.
+ */
+void i2cDeviceWrite(I2CDevice* device, byte reg, byte value);
+
+
+/**
+ * @brief 
+ * Reads a register from the cache.
+ *
+ * @returns
+ *      False if its value isn't known yet
+ *      or the register isn't cached.
+ */
+bool i2cDeviceGet(I2CDevice* device, byte reg, byte* value);
+
+
+/**
+ * @brief 
+ * Blocks until the running flush 
+ * or load is over.
+ *
+ * @returns
+ *      Its result.
+ */
+I2CStatus i2cDeviceWait(I2CDevice* device);
+
+
+/**
+ * @brief 
+ * Tells whether a flush or a 
+ * load is running.
+ */
+#define I2C_DEVICE_IS_BUSY(device) \
+    ((device)->status == I2C_PENDING)
+
+
+/**
+ * @brief 
+ * Probes every address from I2C_SCAN_FIRST to 
+ * I2C_SCAN_LAST with an address-only transaction.
+ * Blocks until the scan is over.
+ *
+ * @param found
+ *      Receives the addresses that answered.
+ *
+ * @param size
+ *      The maximum number of addresses to store.
+ *
+ * @returns
+ *      The number of addresses found, 
+ *      even if more than size.
+ */
+byte i2cScanBus(byte* found, byte size);
+
+
+#endif // !I2C_DEVICE_H
@@ -1,4 +1,3 @@
-#include <stdlib.h>
 #include "linkedList.h"
 #include "utility.h"
 
@@ -8,7 +7,9 @@
 Node* createNode(void* content, Node* previous, Node* next)
 {
     Node* result = 
-        (Node*)malloc(sizeof(Node));
+        (Node*)memPoolAlloc(sizeof(Node));
+
+    if (result == NULL) return NULL;
 
     result->content = content;
     
@@ -33,6 +34,8 @@ Node* llAdd(Node* start, void* content)
     Node* new = 
         createNode(content, end, NULL);
 
+    if (new == NULL) return NULL;
+
     // Adding the new node to the
     // list
     end->next = new;
@@ -167,10 +170,10 @@ void llRemoveAt(Node** start, int index, bool freeContent)
     llLinkTwo(prev, next);
     
     if (freeContent)
-        free(node->content);
+        memFree(node->content);
     
     // Freeing the memory used by the node
-    free(node);
+    memFree(node);
     
     if (index == 0) *start = next;
 }
@@ -182,7 +185,22 @@ void llRemoveAt(Node** start, int index, bool freeContent)
  */
 void llRemove(Node** start, Node* target, bool freeContent)
 {
-    if (*start == NULL || target == NULL) return;
+    if (!llUnlink(start, target)) return;
+    
+    if (freeContent)
+        memFree(target->content);
+    
+    memFree(target);
+}
+
+
+/**
+ * @brief Removes a target node from a linked 
+ * list without freeing it.
+ */
+bool llUnlink(Node** start, Node* target)
+{
+    if (*start == NULL || target == NULL) return false;
     
     register Node* current;
     for (
@@ -203,13 +221,11 @@ void llRemove(Node** start, Node* target, bool freeContent)
                     target->previous,
                     target->next);
             
-            if (freeContent)
-                free(target->content);
-            
-            free(target);
-            return;
+            return true;
         }
     }
+    
+    return false;
 }
 
 
@@ -232,9 +248,9 @@ void llRemoveLast(Node** start, bool freeContent)
     llLinkTwo(last->previous, NULL);
     
     if (freeContent)
-        free(last->content);
+        memFree(last->content);
     
-    free(last);
+    memFree(last);
 }
 
 /**
@@ -283,12 +299,12 @@ void llClear(Node** start, bool freeContent)
         current != NULL
         ;
         current = next, 
-        next = (current == NULL ? current->next : NULL))
+        next = (current != NULL ? current->next : NULL))
     {
         if (freeContent)
-            free(current->content);
+            memFree(current->content);
         
-        free(current);
+        memFree(current);
     }
     
     *start = NULL;
@@ -2,6 +2,7 @@
 #define LINKED_LIST_H
 
 #include "utility.h"
+#include "memoryManager.h"
 
 /**
  * @brief Represents a node inside a 
@@ -39,8 +40,8 @@ void llLinkThree(Node* previous, register Node* middle, Node* next);
 
 
 /**
- * @brief Allocated a new Node and returns a pointer
- * to it.
+ * @brief Allocated a new Node from the memory pools 
+ * and returns a pointer to it, NULL if out of memory.
  * 
  * @param content A pointer to this node's content.
  * @param previous A pointer to the previous node.
@@ -54,7 +55,7 @@ Node* createNode(void* content, Node* previous, Node* next);
  * 
  * @param start The beginning element of the list.
  * @param content The content of the new Node.
- * @returns The new node.
+ * @returns The new node, NULL if out of memory.
  */
 Node* llAdd(Node* start, void* content);
 
@@ -106,7 +107,7 @@ int llLength(Node* start);
  *      The index of the element that needs to be removed.
  * 
  * @param freeContent
- *      Tells whether the function should call free on the
+ *      Tells whether the function should call memFree on the
  *      Node's content too.
  */
 void llRemoveAt(Node** start, int index, bool freeContent);
@@ -125,11 +126,22 @@ void llRemoveAt(Node** start, int index, bool freeContent);
  *      A pointer to the node that needs to be removed.
  *
  * @param freeContent
- *      Tells whether the function should call free on the
+ *      Tells whether the function should call memFree on the
  *      Node's content too.
  */
 void llRemove(Node** start, Node* target, bool freeContent);   
 
+/**
+ * @brief Removes a target node from a linked list
+ * without freeing it. 
+ * Doesn't allocate nor free: can be used by 
+ * the interrupts, which must not call memFree.
+ *
+ * @returns
+ *      False if the node isn't in the list.
+ */
+bool llUnlink(Node** start, Node* target);
+
 /**
  * @brief Removes the last node from the linked list.
  *
@@ -140,7 +152,7 @@ void llRemove(Node** start, Node* target, bool freeContent);
  *      set the first node to NULL if it is removed.
  *
  * @param freeContent
- *      Tells whether the function should call free on the
+ *      Tells whether the function should call memFree on the
  *      Node's content too.
  */
 void llRemoveLast(Node** start, bool freeContent);
@@ -157,7 +169,7 @@ void llRemoveLast(Node** start, bool freeContent);
  *      set the beginning node to NULL.
  * 
  * @param freeContent
- *      Tells whether the function should call free on the
+ *      Tells whether the function should call memFree on the
  *      Node's content too.
  */
 void llClear(Node** start, bool freeContent);
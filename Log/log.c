@@ -0,0 +1,98 @@
+#ifndef LOG_C
+#define LOG_C
+
+#include "io430f5529.h"
+#include "log.h"
+#include "serial.h"
+
+
+/**
+ * @brief The log ring: records are added at
+ * _head and sent from _tail.
+ */
+static byte          _ring[LOG_RING_SIZE];
+static volatile uint _head = 0;
+static volatile uint _tail = 0;
+
+static volatile uint _dropped = 0;
+
+
+#define LOG_MASK (LOG_RING_SIZE - 1)
+
+/**
+ * @brief Adds a byte at the given position,
+ * which is moved to the next byte.
+ */
+#define LOG_PUT(position, data)                 \
+    {                                           \
+        _ring[position] = (byte)(data);         \
+        position = (position + 1) & LOG_MASK;   \
+    }
+
+
+bool logWrite(uint id, byte argc, uint a, uint b, uint c, uint d)
+{
+    register uint position;
+    uint args[LOG_MAX_ARGS];
+    byte length = 4 + 2 * argc;
+    byte i;
+    bool written = false;
+
+    args[0] = a;
+    args[1] = b;
+    args[2] = c;
+    args[3] = d;
+
+    // The interrupts can log too:
+    // a record is written at once
+    ATOMIC
+    (
+        position = _head;
+
+        // A byte is kept free to tell
+        // a full ring from an empty one
+        if (((_tail - position - 1) & LOG_MASK) >= length)
+        {
+            LOG_PUT(position, LOG_SYNC);
+            LOG_PUT(position, id);
+            LOG_PUT(position, id >> 8);
+            LOG_PUT(position, argc);
+
+            for (i = 0; i < argc; i++)
+            {
+                LOG_PUT(position, args[i]);
+                LOG_PUT(position, args[i] >> 8);
+            }
+
+            _head   = position;
+            written = true;
+        }
+        else
+            _dropped++;
+    );
+
+    return written;
+}
+
+
+bool logDrain(void)
+{
+    while (_tail != _head)
+    {
+        if (!Serial.writeCharAsync(_ring[_tail]))
+            return false;
+
+        _tail = (_tail + 1) & LOG_MASK;
+    }
+
+    return true;
+}
+
+
+uint logDropped(void)
+{
+    return _dropped;
+}
+
+
+#endif // !LOG_C
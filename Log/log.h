@@ -0,0 +1,170 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include "utility.h"
+
+
+#ifndef LOG_ENABLED
+/**
+ * @brief Compiles the log calls:
+ * with 0 the LOG macros are empty.
+ */
+#define LOG_ENABLED 1
+#endif // !LOG_ENABLED
+
+
+#ifndef LOG_RING_SIZE
+/**
+ * @brief The size of the log ring in bytes,
+ * a power of 2.
+ */
+#define LOG_RING_SIZE 256
+#endif // !LOG_RING_SIZE
+
+
+/**
+ * @brief The maximum number of arguments of
+ * a log call, each a 16 bits word.
+ */
+#define LOG_MAX_ARGS 4
+
+
+/**
+ * @brief
+ * The first byte of each record, to find
+ * the records in the serial stream.
+ * A record is:
+ *
+ *   LOG_SYNC, id (2 bytes), argc, argc words
+ *
+ * little endian, where id is the offset of the
+ * format string in its section.
+ */
+#define LOG_SYNC 0xA6
+
+
+/*
+ * The format strings are kept in their own section, which
+ * is not programmed: the firmware only sends their offsets,
+ * the host decoder (Host/logDecode.c) reads them from the
+ * output file. The section is placed by Log/logstr.xcl
+ * (XLINK, above the device memory, hence __data20) and
+ * Log/logstr.ld (GCC, a non-allocated section).
+ */
+#if defined(__IAR_SYSTEMS_ICC__)
+
+#pragma segment = "LOGSTR" __data20
+
+#define LOG_SECTION       _Pragma("location = \"LOGSTR\"") __root __data20
+#define LOG_SECTION_START ((const char __data20*)__segment_begin("LOGSTR"))
+
+#else
+
+extern const char __start_logstr[];
+
+#define LOG_SECTION       __attribute__((section("logstr"), used))
+#define LOG_SECTION_START (__start_logstr)
+
+#endif
+
+
+#if LOG_ENABLED
+
+/**
+ * @brief
+ * Logs a printf-like format with up to LOG_MAX_ARGS
+ * int or unsigned arguments (%d %u %x %c, with the
+ * usual flags and width). A long is passed as two
+ * arguments, LOG_LOW and LOG_HIGH, and printed with
+ * %ld %lu %lx.
+ * Nothing is formatted on the device.
+ */
+#define LOG0(format) \
+    LOG_WRITE(format, 0, 0, 0, 0, 0)
+
+#define LOG1(format, a) \
+    LOG_WRITE(format, 1, (a), 0, 0, 0)
+
+#define LOG2(format, a, b) \
+    LOG_WRITE(format, 2, (a), (b), 0, 0)
+
+#define LOG3(format, a, b, c) \
+    LOG_WRITE(format, 3, (a), (b), (c), 0)
+
+#define LOG4(format, a, b, c, d) \
+    LOG_WRITE(format, 4, (a), (b), (c), (d))
+
+#else
+
+#define LOG0(format)              ((void)0)
+#define LOG1(format, a)           ((void)0)
+#define LOG2(format, a, b)        ((void)0)
+#define LOG3(format, a, b, c)     ((void)0)
+#define LOG4(format, a, b, c, d)  ((void)0)
+
+#endif // LOG_ENABLED
+
+
+/**
+ * @brief
+ * The two arguments of a %l conversion,
+ * low word first.
+ */
+#define LOG_LOW(value)  ((uint)(ulong)(value))
+#define LOG_HIGH(value) ((uint)((ulong)(value) >> 16))
+
+
+/**
+ * @brief
+ * A statement wherever a function call is:
+ * in an if without braces too.
+ */
+#define LOG_WRITE(format, argc, a, b, c, d)                     \
+    do                                                          \
+    {                                                           \
+        LOG_SECTION static const char _logFormat[] = format;    \
+        logWrite(                                               \
+            (uint)(_logFormat - LOG_SECTION_START), (argc),     \
+            (uint)(a), (uint)(b), (uint)(c), (uint)(d));        \
+    } while (0)
+
+
+/**
+ * @brief
+ * Adds a record to the log ring, unless it's full.
+ * Called by the LOG macros, from the main loop
+ * or from the interrupts.
+ *
+ * @param id
+ *      The offset of the format string.
+ *
+ * @param argc
+ *      The number of arguments used.
+ *
+ * @returns
+ *      False if the record was dropped.
+ */
+bool logWrite(uint id, byte argc, uint a, uint b, uint c, uint d);
+
+
+/**
+ * @brief
+ * Sends the records over Serial until its tx
+ * buffer is full, without blocking: called
+ * by the main loop.
+ *
+ * @returns
+ *      True if the log ring is empty.
+ */
+bool logDrain(void);
+
+
+/**
+ * @brief
+ * The records lost because the
+ * ring was full.
+ */
+uint logDropped(void);
+
+
+#endif // !LOG_H
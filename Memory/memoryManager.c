@@ -0,0 +1,227 @@
+#ifndef MEMORY_MANAGER_C
+#define MEMORY_MANAGER_C
+
+#include "memoryManager.h"
+#include <stdlib.h>
+
+
+/**
+ * The allocator is not reentrant: it must never
+ * be called from an interrupt. The drivers defer
+ * their frees to the main context.
+ */
+
+
+/**
+ * @brief Rounds a size to whole words, 
+ * so that every block is aligned.
+ */
+#define WORD_ALIGN(size) (((size) + 1) & ~1)
+
+
+typedef struct MemoryPool
+{
+    uint  blockSize;
+    uint  blocks;
+    byte* storage;
+    
+    /**
+     * @brief The freed blocks, each one holding
+     * the next, and the blocks never used yet.
+     */
+    void** _free;
+    uint   _carved;
+    
+    uint _used;
+    uint _peak;
+    
+} MemoryPool;
+
+
+#if MEMORY_STATIC
+
+// Declared as words to be aligned
+static uint _arena[WORD_ALIGN(MEMORY_ARENA_SIZE) / 2];
+static uint _storage0[MEMORY_POOL0_BLOCKS * MEMORY_POOL0_SIZE / 2];
+static uint _storage1[MEMORY_POOL1_BLOCKS * MEMORY_POOL1_SIZE / 2];
+static uint _storage2[MEMORY_POOL2_BLOCKS * MEMORY_POOL2_SIZE / 2];
+
+static MemoryPool _pools[MEMORY_POOLS] =
+{
+    { MEMORY_POOL0_SIZE, MEMORY_POOL0_BLOCKS, (byte*)_storage0, NULL, 0, 0, 0 },
+    { MEMORY_POOL1_SIZE, MEMORY_POOL1_BLOCKS, (byte*)_storage1, NULL, 0, 0, 0 },
+    { MEMORY_POOL2_SIZE, MEMORY_POOL2_BLOCKS, (byte*)_storage2, NULL, 0, 0, 0 }
+};
+
+static uint _arenaUsed = 0;
+
+#endif // MEMORY_STATIC
+
+static uint _failures = 0;
+
+
+#if MEMORY_STATIC
+
+/**
+ * @brief Takes a block from the smallest pool 
+ * whose blocks fit and aren't all used, 
+ * without counting a failure.
+ *
+ * @param fits
+ *      Whether a pool has blocks big enough.
+ */
+static void* _poolAlloc(uint size, bool* fits)
+{
+    register byte i;
+    
+    *fits = false;
+    
+    for (i = 0; i < MEMORY_POOLS; i++)
+    {
+        MemoryPool* pool = &_pools[i];
+        void* result;
+        
+        if (size > pool->blockSize)
+            continue;
+        
+        *fits = true;
+        
+        if (pool->_free != NULL)
+        {
+            result      = pool->_free;
+            pool->_free = (void**)*pool->_free;
+        }
+        else if (pool->_carved < pool->blocks)
+            result = pool->storage + pool->blockSize * pool->_carved++;
+        
+        else
+            continue;
+        
+        if (++(pool->_used) > pool->_peak)
+            pool->_peak = pool->_used;
+        
+        return result;
+    }
+    
+    return NULL;
+}
+
+#endif // MEMORY_STATIC
+
+
+void* memAlloc(uint size)
+{
+#if MEMORY_STATIC
+    size = WORD_ALIGN(size);
+    
+    if (size == 0 || size > sizeof(_arena) - _arenaUsed)
+    {
+        _failures++;
+        return NULL;
+    }
+    
+    void* result = (byte*)_arena + _arenaUsed;
+    _arenaUsed += size;
+    
+    return result;
+#else
+    void* result = malloc(size);
+    
+    if (result == NULL)
+        _failures++;
+    
+    return result;
+#endif // MEMORY_STATIC
+}
+
+
+void* memPoolAlloc(uint size)
+{
+#if MEMORY_STATIC
+    bool  fits;
+    void* result = _poolAlloc(size, &fits);
+    
+    // Too big for the pools isn't counted: 
+    // the caller can use the arena
+    if (result == NULL && fits)
+        _failures++;
+    
+    return result;
+#else
+    return memAlloc(size);
+#endif // MEMORY_STATIC
+}
+
+
+void* memAllocAny(uint size)
+{
+#if MEMORY_STATIC
+    bool  fits;
+    void* result = _poolAlloc(size, &fits);
+    
+    // A failure only if the arena fails too
+    return (result != NULL) ? result : memAlloc(size);
+#else
+    return memAlloc(size);
+#endif // MEMORY_STATIC
+}
+
+
+void memFree(void* block)
+{
+#if MEMORY_STATIC
+    register byte i;
+    
+    for (i = 0; i < MEMORY_POOLS; i++)
+    {
+        MemoryPool* pool = &_pools[i];
+        
+        if ((byte*)block >= pool->storage && 
+            (byte*)block <  pool->storage + pool->blockSize * pool->blocks)
+        {
+            *(void**)block = pool->_free;
+            pool->_free    = (void**)block;
+            pool->_used--;
+            return;
+        }
+    }
+#else
+    free(block);
+#endif // MEMORY_STATIC
+}
+
+
+void memGetStats(MemoryStats* stats)
+{
+    register byte i;
+    
+#if MEMORY_STATIC
+    stats->arenaUsed = _arenaUsed;
+    stats->arenaSize = sizeof(_arena);
+    
+    for (i = 0; i < MEMORY_POOLS; i++)
+    {
+        stats->poolBlockSize[i] = _pools[i].blockSize;
+        stats->poolBlocks[i]    = _pools[i].blocks;
+        stats->poolUsed[i]      = _pools[i]._used;
+        stats->poolPeak[i]      = _pools[i]._peak;
+    }
+#else
+    // Only the failures are known
+    stats->arenaUsed = 0;
+    stats->arenaSize = 0;
+    
+    for (i = 0; i < MEMORY_POOLS; i++)
+    {
+        stats->poolBlockSize[i] = 0;
+        stats->poolBlocks[i]    = 0;
+        stats->poolUsed[i]      = 0;
+        stats->poolPeak[i]      = 0;
+    }
+#endif // MEMORY_STATIC
+    
+    stats->failures = _failures;
+}
+
+
+#endif // !MEMORY_MANAGER_C
@@ -0,0 +1,123 @@
+#ifndef MEMORY_MANAGER_H
+#define MEMORY_MANAGER_H
+
+#include "utility.h"
+
+
+#ifndef MEMORY_STATIC
+/**
+ * @brief When 1 all the library's allocations 
+ * come from the static arena and pools below,
+ * and malloc is never called.
+ * When 0 they use malloc and free.
+ */
+#define MEMORY_STATIC 1
+#endif // !MEMORY_STATIC
+
+
+#ifndef MEMORY_ARENA_SIZE
+/**
+ * @brief The bytes of the arena, for the 
+ * objects that live forever (displays, 
+ * buttons, buffers, ...).
+ */
+#define MEMORY_ARENA_SIZE 512
+#endif // !MEMORY_ARENA_SIZE
+
+
+/**
+ * @brief The size classes of the pools, for the 
+ * objects created and freed at run time (list 
+ * nodes, timers, ...): the size of their blocks 
+ * (even) and the number of blocks.
+ */
+#ifndef MEMORY_POOL0_SIZE
+#define MEMORY_POOL0_SIZE   8
+#define MEMORY_POOL0_BLOCKS 16
+#endif // !MEMORY_POOL0_SIZE
+
+#ifndef MEMORY_POOL1_SIZE
+#define MEMORY_POOL1_SIZE   16
+#define MEMORY_POOL1_BLOCKS 4
+#endif // !MEMORY_POOL1_SIZE
+
+#ifndef MEMORY_POOL2_SIZE
+#define MEMORY_POOL2_SIZE   32
+#define MEMORY_POOL2_BLOCKS 2
+#endif // !MEMORY_POOL2_SIZE
+
+#define MEMORY_POOLS 3
+
+
+/**
+ * @brief The usage of the arena and the pools.
+ * The arena never shrinks: its used bytes are
+ * its high-water mark.
+ */
+typedef struct MemoryStats
+{
+    uint arenaUsed;
+    uint arenaSize;
+    
+    uint poolBlockSize[MEMORY_POOLS];
+    uint poolBlocks   [MEMORY_POOLS];
+    uint poolUsed     [MEMORY_POOLS];
+    uint poolPeak     [MEMORY_POOLS];
+    
+    /**
+     * @brief The allocations that 
+     * returned NULL.
+     */
+    uint failures;
+    
+} MemoryStats;
+
+
+/**
+ * @brief Allocates a block that is never 
+ * freed from the arena.
+ *
+ * @returns
+ *      NULL if the arena is exhausted.
+ */
+void* memAlloc(uint size);
+
+
+/**
+ * @brief Allocates a block from the smallest 
+ * pool whose blocks fit the given size and 
+ * aren't all used.
+ *
+ * @returns
+ *      NULL if no block is available.
+ */
+void* memPoolAlloc(uint size);
+
+
+/**
+ * @brief Allocates a block from the pools 
+ * (memPoolAlloc), or from the arena if none
+ * is available: memFree ignores an arena
+ * block, which is never freed.
+ *
+ * @returns
+ *      NULL if the arena is exhausted too:
+ *      a single failure is counted.
+ */
+void* memAllocAny(uint size);
+
+
+/**
+ * @brief Returns a pool block to its pool.
+ * Arena blocks and NULL are ignored.
+ */
+void memFree(void* block);
+
+
+/**
+ * @brief Copies the current usage.
+ */
+void memGetStats(MemoryStats* stats);
+
+
+#endif // !MEMORY_MANAGER_H
@@ -0,0 +1,76 @@
+#ifndef BCD_C
+#define BCD_C
+
+#include "bcd.h"
+
+
+/**
+ * @brief Converts a 16 bits binary number to 
+ * packed BCD (5 digits).
+ */
+ulong binToBcd16(register uint value)
+{
+    register ulong bcd = 0;
+    register byte  bits;
+    
+    if (value == 0) return 0;
+    
+    // Skipping the leading zeros,
+    // they would only double 0
+    for (bits = 16; !(value & 0x8000); bits--)
+        value <<= 1;
+    
+    for (; bits > 0; bits--, value <<= 1)
+    {
+        // bcd = bcd * 2 + msb, in decimal: the doubled
+        // units are even, so the msb can't carry
+        bcd  = __bcd_add_long(bcd, bcd);
+        bcd |= (value >> 15) & 1;
+    }
+    
+    return bcd;
+}
+
+
+/**
+ * @brief Converts a 32 bits binary number to 
+ * packed BCD (10 digits).
+ */
+unsigned long long binToBcd32(register ulong value)
+{
+    register unsigned long long bcd;
+    register byte bits;
+    
+    // The high word is zero most of the times
+    if (value <= 0xFFFF)
+        return binToBcd16((uint)value);
+    
+    for (bits = 32; !(value & 0x80000000); bits--)
+        value <<= 1;
+    
+    for (bcd = 0; bits > 0; bits--, value <<= 1)
+    {
+        bcd  = __bcd_add_long_long(bcd, bcd);
+        bcd |= (value >> 31) & 1;
+    }
+    
+    return bcd;
+}
+
+
+/**
+ * @brief Returns the number of significant digits
+ * of a packed BCD number.
+ */
+byte bcdDigits(register unsigned long long bcd)
+{
+    register byte digits;
+    
+    for (digits = 1; bcd > 0x0F; digits++)
+        bcd >>= 4;
+    
+    return digits;
+}
+
+
+#endif // !BCD_C
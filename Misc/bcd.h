@@ -0,0 +1,50 @@
+#ifndef BCD_H
+#define BCD_H
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief The number of decimal digits of 
+ * the biggest 16 and 32 bits values.
+ */
+#define BCD16_DIGITS 5
+#define BCD32_DIGITS 10
+
+
+/**
+ * @brief Returns the digit at the given 
+ * position of a packed BCD number, 0 being
+ * the units.
+ */
+#define BCD_DIGIT(bcd, position) \
+    ((byte)((bcd) >> ((position) << 2)) & 0x0F)
+
+
+/**
+ * @brief Converts a 16 bits binary number to 
+ * packed BCD (5 digits), without divisions.
+ * 
+ * Uses the double dabble algorithm, with the
+ * doubling done by the DADD instruction.
+ */
+ulong binToBcd16(uint value);
+
+
+/**
+ * @brief Converts a 32 bits binary number to 
+ * packed BCD (10 digits), without divisions.
+ */
+unsigned long long binToBcd32(ulong value);
+
+
+/**
+ * @brief Returns the number of significant digits
+ * of a packed BCD number, at least 1 
+ * (for 0).
+ */
+byte bcdDigits(unsigned long long bcd);
+
+
+#endif // !BCD_H
@@ -51,7 +51,7 @@ typedef void (*Action)();
  * @param value: The value to set, either HIGH or LOW
  */
 #define SET_PORT(reg, bit, value) \
-  ((value) ? (reg) |= (bit) : (reg) &= ~(bit))
+  ((value) ? ((reg) |= (bit)) : ((reg) &= ~(bit)))
 
 
 /** 
@@ -63,6 +63,18 @@ typedef void (*Action)();
 #define SWITCH_PORT(reg, bit)    \
   ((reg) ^= (bit))
       
+/**
+ * @brief Executes the given code with the
+ * interrupts disabled, then restores them.
+ */
+#define ATOMIC(expr)                                  \
+  {                                                   \
+    __istate_t __state = __get_interrupt_state();     \
+    __disable_interrupt();                            \
+    expr                                              \
+    __set_interrupt_state(__state);                   \
+  }
+
 /*
  * @brief Raises an event if the pointer to the
  * function is not NULL.
@@ -72,7 +84,7 @@ typedef void (*Action)();
     (functionPointer)(); }
 
 
-inline void clamp(ulong *value, ulong min, ulong max) {
+static inline void clamp(ulong *value, ulong min, ulong max) {
   if (*value < min) 
     *value = min;
 
@@ -81,12 +93,12 @@ inline void clamp(ulong *value, ulong min, ulong max) {
 }
 
 
-inline bool allLow(BitVector8b vector) {
+static inline bool allLow(BitVector8b vector) {
   return vector == 0;
 }
 
-inline bool allHigh(BitVector8b vector) {
-  return vector == ~0;
+static inline bool allHigh(BitVector8b vector) {
+  return vector == (BitVector8b)~0;
 }
 
 
@@ -0,0 +1,579 @@
+#ifndef MODBUS_C
+#define MODBUS_C
+
+#include <string.h>
+#include "modbus.h"
+#include "timer.h"
+#include "power.h"
+#include "trace.h"
+
+
+/**
+ * @brief The bits of a character: start, 8 data,
+ * parity (or a second stop) and stop.
+ */
+#define MODBUS_CHARACTER_BITS 11
+
+/*
+ * The silences are timed on the 16 bits counter:
+ * the longest, t3.5 at 9600 baud, must fit.
+ */
+#if MODBUS_SMCLK * MODBUS_CHARACTER_BITS * 7 / 2 / 9600 > 0xFFFF
+#error "t3.5 at 9600 baud doesn't fit the Timer A2: MODBUS_SMCLK is too fast"
+#endif
+
+#define MODBUS_READ_MAX  125
+#define MODBUS_WRITE_MAX 123
+
+
+/**
+ * @brief
+ * The CRC of each byte value. The CRC module of the
+ * F5529 only computes the CCITT polynomial: the Modbus
+ * one is computed a byte at a time from this table.
+ */
+static const uint _crcTable[256] =
+{
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+
+static byte _address = 0;
+
+/**
+ * @brief The silences that end a frame (t3.5) and
+ * that break it (t1.5), in SMCLK cycles.
+ */
+static uint _t35 = 0;
+static uint _t15 = 0;
+
+/**
+ * @brief The frame being received,
+ * seen by the interrupts only.
+ */
+static uint _received = 0;
+static uint _lastByte = 0;
+static bool _broken   = false;
+
+/**
+ * @brief The length of the frame waiting in the rx
+ * buffer, 0 if none, and the bytes after it to skip:
+ * the frames discarded while it waited.
+ */
+static volatile uint _frameLength = 0;
+static volatile uint _skip        = 0;
+
+/**
+ * @brief The request, then its response.
+ */
+static byte _frame[MODBUS_MAX_FRAME];
+
+/**
+ * @brief The part of the response
+ * not in the tx buffer yet.
+ */
+static const byte* _pending       = NULL;
+static uint        _pendingLength = 0;
+
+static const ModbusRegister* _holding      = NULL;
+static uint                  _holdingCount = 0;
+static const ModbusRegister* _input        = NULL;
+static uint                  _inputCount   = 0;
+static ModbusWritten         _written      = NULL;
+
+static ModbusStats _stats;
+
+
+static void  _byteReceived(void);
+static void  _frameEnded(void);
+static ulong _bitsPerSecond(BaudRate baudRate);
+static bool  _sendResponse(void);
+static uint  _serve(uint length);
+static uint  _readRegisters(const ModbusRegister* table, uint count, uint length);
+static uint  _writeRegister(uint length);
+static uint  _writeRegisters(uint length);
+static uint  _exception(ModbusException code);
+static int   _find(
+    const ModbusRegister* table,
+    uint                  count,
+    uint                  address,
+    uint                  quantity);
+
+static inline uint _word(const byte* data)
+{
+    return ((uint)data[0] << 8) | data[1];
+}
+
+static inline void _putWord(byte* data, uint value)
+{
+    data[0] = (byte)(value >> 8);
+    data[1] = (byte)value;
+}
+
+
+bool initModbus(byte address, BaudRate baudRate)
+{
+    ulong bitsPerSecond = _bitsPerSecond(baudRate);
+
+    // A request waits in the rx buffer until
+    // modbusPoll: its bytes would be dropped
+    if (Serial._rx.size < MODBUS_MAX_FRAME)
+        return false;
+
+    _address = address;
+
+    // Fixed times above 19200 baud
+    if (bitsPerSecond > 19200)
+    {
+        _t35 = (uint)(MODBUS_SMCLK / 1000 * 1750 / 1000);
+        _t15 = (uint)(MODBUS_SMCLK / 1000 *  750 / 1000);
+    }
+    else
+    {
+        _t35 = (uint)(MODBUS_SMCLK * MODBUS_CHARACTER_BITS * 7 / 2 / bitsPerSecond);
+        _t15 = (uint)(MODBUS_SMCLK * MODBUS_CHARACTER_BITS * 3 / 2 / bitsPerSecond);
+    }
+
+    ATOMIC
+    (
+        _received    = 0;
+        _broken      = false;
+        _frameLength = 0;
+        _skip        = 0;
+    );
+
+    _pending       = NULL;
+    _pendingLength = 0;
+    modbusGetStats(NULL, true);
+
+    TA2CCTL1 = 0;
+    initCycleCounter();
+
+    Serial.received = &_byteReceived;
+    return true;
+}
+
+
+void modbusSetRegisters(
+    const ModbusRegister* holding,
+    uint                  holdingCount,
+    const ModbusRegister* input,
+    uint                  inputCount,
+    ModbusWritten         written)
+{
+    _holding      = holding;
+    _holdingCount = (holding != NULL) ? holdingCount : 0;
+    _input        = input;
+    _inputCount   = (input != NULL) ? inputCount : 0;
+    _written      = written;
+}
+
+
+bool modbusPoll(void)
+{
+    uint length, skip, i, response;
+    byte data;
+
+    // The frames wait for the previous response
+    if (!_sendResponse())
+        return false;
+
+    ATOMIC
+    (
+        length       = _frameLength;
+        skip         = _skip;
+        _frameLength = 0;
+        _skip        = 0;
+    );
+
+    if (length == 0)
+    {
+        for (; skip > 0; skip--)
+            Serial.readCharAsync(&data);
+
+        return false;
+    }
+
+    // The bytes that don't fit are discarded
+    for (i = 0; i < length; i++)
+    {
+        Serial.readCharAsync(&data);
+
+        if (i < MODBUS_MAX_FRAME)
+            _frame[i] = data;
+    }
+
+    for (; skip > 0; skip--)
+        Serial.readCharAsync(&data);
+
+    if (length > MODBUS_MAX_FRAME || length < 4)
+    {
+        _stats.discarded++;
+        return false;
+    }
+
+    if (modbusCrc(_frame, length) != 0)
+    {
+        _stats.crcErrors++;
+        return false;
+    }
+
+    if (_frame[0] != _address && _frame[0] != MODBUS_BROADCAST)
+        return false;
+
+    _stats.requests++;
+    response = _serve(length);
+
+    // Only the addressed slave answers
+    if (response == 0 || _frame[0] == MODBUS_BROADCAST)
+        return true;
+
+    i = modbusCrc(_frame, response);
+    _frame[response++] = (byte)i;
+    _frame[response++] = (byte)(i >> 8);
+
+    _pending       = _frame;
+    _pendingLength = response;
+    _sendResponse();
+
+    return true;
+}
+
+
+void modbusGetStats(ModbusStats* stats, bool reset)
+{
+    // Also counted by the interrupt
+    ATOMIC
+    (
+        if (stats != NULL)
+            *stats = _stats;
+
+        if (reset)
+            memset(&_stats, 0, sizeof(_stats));
+    );
+}
+
+
+uint modbusCrc(const byte* data, uint length)
+{
+    register uint crc = 0xFFFF;
+
+    for (; length > 0; length--)
+        crc = (crc >> 8) ^ _crcTable[(byte)(crc ^ *data++)];
+
+    return crc;
+}
+
+
+/**
+ * @brief
+ * Called by the Serial interrupt for each byte:
+ * restarts the t3.5 count.
+ */
+static void _byteReceived(void)
+{
+    uint now = CYCLE_COUNTER();
+
+    if (_received > 0 && (uint)(now - _lastByte) > _t15)
+        _broken = true;
+
+    _received++;
+    _lastByte = now;
+
+    // Clears a pending compare too
+    TA2CCR1  = now + _t35;
+    TA2CCTL1 = CCIE;
+}
+
+
+/**
+ * @brief
+ * Called at the t3.5 silence: hands the frame
+ * to modbusPoll, or has it skipped.
+ */
+static void _frameEnded(void)
+{
+    if (_broken || _frameLength != 0)
+    {
+        _skip += _received;
+        _stats.discarded++;
+    }
+    else
+        _frameLength = _received;
+
+    _received = 0;
+    _broken   = false;
+}
+
+
+static ulong _bitsPerSecond(BaudRate baudRate)
+{
+    switch (baudRate)
+    {
+        case BAUD_9600:   return 9600;
+        case BAUD_19200:  return 19200;
+        case BAUD_38400:  return 38400;
+        case BAUD_57600:  return 57600;
+        case BAUD_115200: return 115200;
+    }
+
+    return 9600;
+}
+
+
+/**
+ * @brief
+ * Moves the response to the tx buffer.
+ *
+ * @returns
+ *      True once it's all there.
+ */
+static bool _sendResponse(void)
+{
+    uint written;
+
+    if (_pendingLength == 0)
+        return true;
+
+    written = Serial.writeBuffAsync(_pending, _pendingLength);
+
+    _pending       += written;
+    _pendingLength -= written;
+
+    return _pendingLength == 0;
+}
+
+
+/**
+ * @brief
+ * Serves the request in _frame, writing
+ * the response over it.
+ *
+ * @returns
+ *      The length of the response without
+ *      the CRC, 0 for no response.
+ */
+static uint _serve(uint length)
+{
+    switch (_frame[1])
+    {
+        case MODBUS_READ_HOLDING:
+            return _readRegisters(_holding, _holdingCount, length);
+
+        case MODBUS_READ_INPUT:
+            return _readRegisters(_input, _inputCount, length);
+
+        case MODBUS_WRITE_SINGLE:
+            return _writeRegister(length);
+
+        case MODBUS_WRITE_MULTIPLE:
+            return _writeRegisters(length);
+    }
+
+    return _exception(MODBUS_ILLEGAL_FUNCTION);
+}
+
+
+/**
+ * @brief
+ * Functions 03 and 04:
+ *   request  address, function, start (2), quantity (2)
+ *   response address, function, byte count, values
+ */
+static uint _readRegisters(const ModbusRegister* table, uint count, uint length)
+{
+    uint start    = _word(&_frame[2]);
+    uint quantity = _word(&_frame[4]);
+    uint i;
+    int  first;
+
+    // Nobody would answer
+    if (_frame[0] == MODBUS_BROADCAST)
+        return 0;
+
+    if (length != 8 || quantity == 0 || quantity > MODBUS_READ_MAX)
+        return _exception(MODBUS_ILLEGAL_VALUE);
+
+    first = _find(table, count, start, quantity);
+    if (first < 0)
+        return _exception(MODBUS_ILLEGAL_ADDRESS);
+
+    _frame[2] = (byte)(quantity << 1);
+
+    for (i = 0; i < quantity; i++)
+        _putWord(&_frame[3 + (i << 1)], *table[first + i].value);
+
+    return 3 + (quantity << 1);
+}
+
+
+/**
+ * @brief
+ * Function 06, the response is the request:
+ *   address, function, register (2), value (2)
+ */
+static uint _writeRegister(uint length)
+{
+    uint address = _word(&_frame[2]);
+    uint value   = _word(&_frame[4]);
+    int  index;
+
+    if (length != 8)
+        return _exception(MODBUS_ILLEGAL_VALUE);
+
+    index = _find(_holding, _holdingCount, address, 1);
+    if (index < 0)
+        return _exception(MODBUS_ILLEGAL_ADDRESS);
+
+    *_holding[index].value = value;
+
+    if (_written != NULL)
+        _written(address, value);
+
+    return 6;
+}
+
+
+/**
+ * @brief
+ * Function 16:
+ *   request  address, function, start (2), quantity (2),
+ *            byte count, values
+ *   response address, function, start (2), quantity (2)
+ */
+static uint _writeRegisters(uint length)
+{
+    uint start    = _word(&_frame[2]);
+    uint quantity = _word(&_frame[4]);
+    uint i, value;
+    int  first;
+
+    if (length < 9 ||
+        quantity == 0 || quantity > MODBUS_WRITE_MAX ||
+        _frame[6] != (quantity << 1) ||
+        length != 9 + (uint)_frame[6])
+        return _exception(MODBUS_ILLEGAL_VALUE);
+
+    first = _find(_holding, _holdingCount, start, quantity);
+    if (first < 0)
+        return _exception(MODBUS_ILLEGAL_ADDRESS);
+
+    for (i = 0; i < quantity; i++)
+    {
+        value = _word(&_frame[7 + (i << 1)]);
+        *_holding[first + i].value = value;
+
+        if (_written != NULL)
+            _written(start + i, value);
+    }
+
+    return 6;
+}
+
+
+static uint _exception(ModbusException code)
+{
+    _stats.exceptions++;
+
+    _frame[1] |= MODBUS_EXCEPTION;
+    _frame[2]  = code;
+
+    return 3;
+}
+
+
+/**
+ * @brief
+ * Binary search of the first register, then the
+ * others must follow it.
+ *
+ * @returns
+ *      The index of the first register,
+ *      -1 if any is missing.
+ */
+static int _find(
+    const ModbusRegister* table,
+    uint                  count,
+    uint                  address,
+    uint                  quantity)
+{
+    uint low  = 0;
+    uint high = count;
+    uint middle, i;
+
+    while (low < high)
+    {
+        middle = (low + high) >> 1;
+
+        if (table[middle].address < address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low + quantity > count)
+        return -1;
+
+    for (i = 0; i < quantity; i++)
+        if (table[low + i].address != address + i)
+            return -1;
+
+    return (int)low;
+}
+
+
+#pragma vector = TIMER2_A1_VECTOR
+__interrupt void __modbus_interrupt(void)
+{
+    TRACE_ISR_ENTER(TRACE_MODBUS);
+
+    switch (__even_in_range(TA2IV, TA2IV_TA2IFG))
+    {
+        // t3.5 elapsed
+        case TA2IV_TA2CCR1:
+            TA2CCTL1 = 0;
+            _frameEnded();
+            POWER_POST_WORK();
+            break;
+
+        default:
+            break;
+    }
+
+    TRACE_ISR_EXIT(TRACE_MODBUS);
+    POWER_WAKE_ON_EXIT();
+}
+
+
+#endif // !MODBUS_C
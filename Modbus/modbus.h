@@ -0,0 +1,192 @@
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include "utility.h"
+#include "serial.h"
+
+
+/**
+ * @brief
+ * A Modbus RTU slave on Serial. The frames are
+ * delimited by the silences of 3.5 characters (t3.5),
+ * timed by the Timer A2 compare channel 1 from the
+ * Serial receive interrupt; a frame with a silence
+ * longer than 1.5 characters (t1.5) is discarded.
+ *
+ * Served functions: 03 (read holding registers),
+ * 04 (read input registers), 06 (write single register),
+ * 16 (write multiple registers).
+ *
+ * Timer A2 keeps running as the cycle counter (timer.h),
+ * its interrupt vector belongs to this module.
+ */
+
+
+#ifndef MODBUS_MAX_FRAME
+/**
+ * @brief The size of the frame buffer: the
+ * longest request or response, CRC included.
+ */
+#define MODBUS_MAX_FRAME 256
+#endif // !MODBUS_MAX_FRAME
+
+
+#ifndef MODBUS_SMCLK
+/**
+ * @brief The frequency of SMCLK in Hz,
+ * which clocks the Timer A2. At most about
+ * 16 MHz: t3.5 at 9600 baud is counted in
+ * 16 bits.
+ */
+#define MODBUS_SMCLK 1048576UL
+#endif // !MODBUS_SMCLK
+
+
+/**
+ * @brief The address of the requests
+ * to all the slaves, never answered.
+ */
+#define MODBUS_BROADCAST 0x00
+
+
+typedef enum ModbusFunction
+{
+    MODBUS_READ_HOLDING    = 0x03,
+    MODBUS_READ_INPUT      = 0x04,
+    MODBUS_WRITE_SINGLE    = 0x06,
+    MODBUS_WRITE_MULTIPLE  = 0x10,
+
+    /**
+     * @brief Set in the function code
+     * of an exception response.
+     */
+    MODBUS_EXCEPTION       = 0x80
+} ModbusFunction;
+
+
+typedef enum ModbusException
+{
+    MODBUS_ILLEGAL_FUNCTION = 0x01,
+    MODBUS_ILLEGAL_ADDRESS  = 0x02,
+    MODBUS_ILLEGAL_VALUE    = 0x03
+} ModbusException;
+
+
+/**
+ * @brief
+ * A register mapped to the application memory.
+ * The tables are sorted by address: a request
+ * for several registers needs consecutive
+ * addresses in consecutive entries.
+ */
+typedef struct ModbusRegister
+{
+    uint           address;
+    volatile uint* value;
+
+} ModbusRegister;
+
+
+/**
+ * @brief
+ * Called from modbusPoll after a holding
+ * register was written by the master.
+ */
+typedef void (*ModbusWritten)(uint address, uint value);
+
+
+typedef struct ModbusStats
+{
+    /**
+     * @brief The requests to this slave
+     * (or broadcast) served.
+     */
+    uint requests;
+
+    /**
+     * @brief The frames with a wrong CRC.
+     */
+    uint crcErrors;
+
+    /**
+     * @brief The frames broken by a t1.5 silence,
+     * too long, or received while another one
+     * was waiting.
+     */
+    uint discarded;
+
+    /**
+     * @brief The exception responses sent.
+     */
+    uint exceptions;
+
+} ModbusStats;
+
+
+/**
+ * @brief
+ * Starts serving the requests to the given address.
+ * Serial must be open at the given baud rate, with
+ * buffers (Serial.buffSize) of MODBUS_MAX_FRAME bytes
+ * at least: a request waits in the rx buffer until
+ * modbusPoll reads it, and the characters of a
+ * response must not be sent apart.
+ * Starts the cycle counter (initCycleCounter).
+ *
+ * @returns
+ *      False if the rx buffer can't hold
+ *      the longest request.
+ */
+bool initModbus(byte address, BaudRate baudRate);
+
+
+/**
+ * @brief
+ * Maps the holding (read and write) and the
+ * input (read only) registers. A table can be
+ * NULL if empty.
+ *
+ * @param written
+ *      Called after each holding register written,
+ *      can be NULL.
+ */
+void modbusSetRegisters(
+    const ModbusRegister* holding,
+    uint                  holdingCount,
+    const ModbusRegister* input,
+    uint                  inputCount,
+    ModbusWritten         written);
+
+
+/**
+ * @brief
+ * Serves the frame received, if any, and sends
+ * its response, without blocking: called by the
+ * main loop, woken at the end of each frame.
+ * The response is sent as soon as the request is
+ * served, the master waits for it.
+ *
+ * @returns
+ *      True if a request was served.
+ */
+bool modbusPoll(void);
+
+
+/**
+ * @brief
+ * Copies the counters, and clears
+ * them if reset is true.
+ */
+void modbusGetStats(ModbusStats* stats, bool reset);
+
+
+/**
+ * @brief
+ * The Modbus CRC16 (polynomial 0xA001, reflected),
+ * sent low byte first: the CRC of a whole frame,
+ * its CRC included, is 0.
+ */
+uint modbusCrc(const byte* data, uint length);
+
+
+#endif // !MODBUS_H
@@ -0,0 +1,408 @@
+#ifndef MUX_SEVEN_SEG_C
+#define MUX_SEVEN_SEG_C
+
+#include "muxSevenSeg.h"
+#include "memoryManager.h"
+#include "power.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @brief The display refreshed by the 
+ * Timer A1 interrupt.
+ */
+static MuxSevenSegInfo* _display = NULL;
+
+
+/**
+ * @brief Allocates a MuxSevenSegInfo structure
+ * and returns a pointer to it.
+ */
+MuxSevenSegInfo* createMuxSevenSegInfo(
+             SevenSegmentInfo* segmentInfo,
+             volatile unsigned char* digitsRegister,
+             volatile unsigned char* digitsDirRegister,
+             const byte* digitPins,
+             byte digits,
+             bool activeLow)
+{
+    MuxSevenSegInfo* result = 
+        (MuxSevenSegInfo*)memAlloc(sizeof(MuxSevenSegInfo));
+    
+    register byte i;
+    byte mask = 0;
+    
+    if (result == NULL) return NULL;
+    
+    if (digits > MUX_SEVEN_SEG_MAX_DIGITS)
+        digits = MUX_SEVEN_SEG_MAX_DIGITS;
+    
+    for (i = 0; i < digits; i++)
+        mask |= digitPins[i];
+    
+    // Pre-computing the digits port values,
+    // so that the interrupt only has to write them
+    for (i = 0; i < digits; i++)
+    {
+        result->_select[i] = 
+            activeLow ? (mask & ~digitPins[i]) : digitPins[i];
+        
+        result->_segmentsOn[i]   = 0;
+        result->_segmentsKeep[i] = SEG_DATA;
+        result->_onTime[i]       = 0;
+    }
+    
+    result->segmentInfo       = segmentInfo;
+    result->digitsRegister    = digitsRegister;
+    result->digitsDirRegister = digitsDirRegister;
+    result->digits            = digits;
+    result->_digitsMask       = mask;
+    result->_digitsOff        = activeLow ? mask : 0;
+    result->_period           = 0;
+    
+    memset(result->_frames, 0, sizeof(result->_frames));
+    result->_front   = result->_frames[0];
+    result->_pending = NULL;
+    result->_text    = NULL;
+    result->_back    = 1;
+    result->_current = 0;
+    
+    *digitsRegister    = (*digitsRegister & ~mask) | result->_digitsOff;
+    *digitsDirRegister |= mask; // Digits dir on output
+    
+    return result;
+}
+
+
+/**
+ * @brief Starts refreshing a display with the
+ * Timer A1, one digit per interrupt.
+ */
+void muxSevenSegStart(MuxSevenSegInfo* muxInfo, unsigned int ccr0Delay)
+{
+    muxInfo->_period = ccr0Delay;
+    muxSevenSegBrightnessAll(muxInfo, MUX_SEVEN_SEG_MAX_BRIGHTNESS);
+    
+    _display = muxInfo;
+    powerRequire(POWER_DISPLAY, POWER_LPM0);
+    
+    TA1CTL = 
+        TASSEL_2 + // Select TAR Clock source = smclk
+        MC_1     + // Count mode up
+        TACLR;
+    
+    TA1CCR0  = ccr0Delay; // Set digit period
+    TA1CCR1  = 0;
+    TA1CCTL0 = CCIE;      // Enable CCR0 interrupt
+    TA1CCTL1 = CCIE;      // Enable CCR1 interrupt (blanking)
+}
+
+
+/**
+ * @brief Stops the refresh and turns 
+ * off the digits.
+ */
+void muxSevenSegStop(void)
+{
+    TA1CCTL0 &= ~CCIE;
+    TA1CCTL1 &= ~CCIE;
+    TA1CTL   &= ~MC_3;
+    powerRelease(POWER_DISPLAY);
+    
+    if (_display == NULL) return;
+    
+    *(_display->digitsRegister) = 
+        (*(_display->digitsRegister) & ~(_display->_digitsMask)) 
+        | _display->_digitsOff;
+    
+    _display = NULL;
+}
+
+
+/**
+ * @brief Returns the frame buffer not being shown.
+ */
+byte* muxSevenSegBackBuffer(MuxSevenSegInfo* muxInfo)
+{
+    // The back buffer is still waiting to be 
+    // shown, or is being shown: woken by the 
+    // interrupt when it's swapped
+    while (MUX_SEVEN_SEG_SWAP_PENDING(muxInfo) && _display == muxInfo)
+        powerIdle();
+    
+    return muxInfo->_frames[muxInfo->_back];
+}
+
+
+/**
+ * @brief Shows the back buffer from the 
+ * next frame.
+ */
+void muxSevenSegSwap(MuxSevenSegInfo* muxInfo)
+{
+    muxSevenSegShow(muxInfo, muxInfo->_frames[muxInfo->_back]);
+    muxInfo->_back ^= 1;
+}
+
+
+/**
+ * @brief Shows an external frame from 
+ * the next frame.
+ */
+inline void muxSevenSegShow(MuxSevenSegInfo* muxInfo, const byte* frame)
+{
+    muxInfo->_text = NULL;
+    
+    // The interrupt isn't running: 
+    // no frame to wait for
+    if (_display != muxInfo)
+        muxInfo->_front = frame;
+    
+    else
+        muxInfo->_pending = frame;
+}
+
+
+/**
+ * @brief Writes an hexadecimal number to the
+ * display, right aligned.
+ */
+void muxSevenSegWriteHex(MuxSevenSegInfo* muxInfo, unsigned long value)
+{
+    byte* frame = muxSevenSegBackBuffer(muxInfo);
+    register byte i;
+    
+    for (i = muxInfo->digits; i > 0; i--, value >>= 4)
+        frame[i - 1] = hexToSevenSeg((unsigned char)value);
+    
+    muxSevenSegSwap(muxInfo);
+}
+
+
+/**
+ * @brief Writes a signed decimal number to the
+ * display, right aligned and without leading zeros.
+ */
+bool muxSevenSegWriteDec(MuxSevenSegInfo* muxInfo, long value)
+{
+    bool result = decToSevenSeg(
+        value, 
+        muxSevenSegBackBuffer(muxInfo), 
+        muxInfo->digits);
+    
+    muxSevenSegSwap(muxInfo);
+    return result;
+}
+
+
+/**
+ * @brief Sets the brightness of a digit.
+ */
+void muxSevenSegBrightness(MuxSevenSegInfo* muxInfo, byte digit, byte brightness)
+{
+    if (digit >= muxInfo->digits) return;
+    
+    // Leaving the blanking interval at 
+    // the end of each digit's period
+    unsigned int maxOnTime = 
+        muxInfo->_period > MUX_SEVEN_SEG_BLANK_TICKS
+        ? muxInfo->_period - MUX_SEVEN_SEG_BLANK_TICKS
+        : 0;
+    
+    muxInfo->_onTime[digit] = (unsigned int)
+        (((unsigned long)maxOnTime * brightness) / MUX_SEVEN_SEG_MAX_BRIGHTNESS);
+}
+
+
+/**
+ * @brief Sets the brightness of all the digits.
+ */
+void muxSevenSegBrightnessAll(MuxSevenSegInfo* muxInfo, byte brightness)
+{
+    register byte i;
+    
+    for (i = 0; i < muxInfo->digits; i++)
+        muxSevenSegBrightness(muxInfo, i, brightness);
+}
+
+
+/**
+ * @brief Forces some segments of a digit on or off.
+ */
+void muxSevenSegOverride(MuxSevenSegInfo* muxInfo, byte digit, byte on, byte off)
+{
+    if (digit >= muxInfo->digits) return;
+    
+    muxInfo->_segmentsOn[digit]   = (muxInfo->_segmentsOn[digit] | on) & ~off;
+    muxInfo->_segmentsKeep[digit] = (muxInfo->_segmentsKeep[digit] | on) & ~off;
+}
+
+
+/**
+ * @brief Encodes a text to scroll it through a 
+ * display from right to left.
+ */
+unsigned int muxSevenSegTextInit(
+             MuxSevenSegInfo* muxInfo,
+             MuxSevenSegText* text,
+             byte* buffer,
+             unsigned int size,
+             const char* string,
+             unsigned int rate,
+             bool loop)
+{
+    const byte digits = muxInfo->digits;
+    
+    if (size < 2 * digits) return 0;
+    
+    // The text enters from the right
+    // and leaves from the left
+    memset(buffer, 0, digits);
+    
+    // Encoded in the room of the trailing blanks 
+    // too: longer than size - 2 * digits, the 
+    // text doesn't fit
+    unsigned int length = 
+        textToSevenSeg(string, buffer + digits, size - digits);
+    
+    if (length > size - 2 * digits) return 0;
+    
+    length += digits;
+    memset(buffer + length, 0, digits);
+    
+    text->segments   = buffer;
+    text->last       = buffer + length;
+    text->step       = 1;
+    text->rate       = rate > 0 ? rate : 1;
+    text->loop       = loop;
+    text->_countdown = text->rate;
+    
+    return length + digits;
+}
+
+
+/**
+ * @brief Initializes an animation from 
+ * consecutive frames as wide as the display.
+ */
+void muxSevenSegAnimationInit(
+             MuxSevenSegInfo* muxInfo,
+             MuxSevenSegText* animation,
+             const byte* frames,
+             unsigned int count,
+             unsigned int rate,
+             bool loop)
+{
+    animation->segments   = frames;
+    animation->last       = frames + (count > 0 ? count - 1 : 0) * muxInfo->digits;
+    animation->step       = muxInfo->digits;
+    animation->rate       = rate > 0 ? rate : 1;
+    animation->loop       = loop;
+    animation->_countdown = animation->rate;
+}
+
+
+/**
+ * @brief Plays a text or an animation from 
+ * its first frame.
+ */
+void muxSevenSegPlay(MuxSevenSegInfo* muxInfo, MuxSevenSegText* text)
+{
+    muxSevenSegShow(muxInfo, text->segments);
+    
+    text->_countdown = text->rate;
+    muxInfo->_text = text;
+}
+
+
+/**
+ * @brief Interrupt called at each period of the 
+ * timer 1 (CCR0): shows the next digit.
+ * All the digits are already off (CCR1).
+ */
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void __mux_seven_seg_interrupt(void)
+{
+    register MuxSevenSegInfo* display = _display;
+    register byte digit = display->_current;
+    
+    TRACE_ISR_ENTER(TRACE_DISPLAY);
+    
+    // New frames start from the first digit,
+    // so that they never tear
+    if (digit == 0)
+    {
+        register MuxSevenSegText* text = display->_text;
+        
+        if (display->_pending != NULL)
+        {
+            display->_front   = display->_pending;
+            display->_pending = NULL;
+            
+            // The back buffer is free
+            POWER_POST_WORK();
+        }
+        
+        // Moving the played text or animation
+        // to its next position
+        else if (text != NULL && --(text->_countdown) == 0)
+        {
+            text->_countdown = text->rate;
+            
+            if (display->_front < text->last)
+                display->_front += text->step;
+            
+            else if (text->loop)
+                display->_front = text->segments;
+            
+            else
+                display->_text = NULL;
+        }
+    }
+    
+    *(display->segmentInfo->segmentsRegister) = 
+        (display->_front[digit] | display->_segmentsOn[digit]) 
+        & display->_segmentsKeep[digit];
+    
+    // The end of the on time is set before the digit is
+    // selected. A digit with no brightness, or whose on
+    // time already elapsed (the interrupt latency), stays
+    // off: its compare would only match the next period.
+    TA1CCR1 = display->_onTime[digit];
+    
+    if (display->_onTime[digit] > TA1R)
+        *(display->digitsRegister) = 
+            (*(display->digitsRegister) & ~(display->_digitsMask)) 
+            | display->_select[digit];
+    
+    display->_current = 
+        (++digit < display->digits) 
+        ? digit 
+        : 0;
+    
+    TRACE_ISR_EXIT(TRACE_DISPLAY);
+    POWER_WAKE_ON_EXIT();
+}
+
+
+/**
+ * @brief Interrupt called when the digit's on time 
+ * is elapsed (CCR1): turns off all the digits until
+ * the next period.
+ */
+#pragma vector = TIMER1_A1_VECTOR
+__interrupt void __mux_seven_seg_blank_interrupt(void)
+{
+    switch (__even_in_range(TA1IV, TA1IV_TA1IFG))
+    {
+        case TA1IV_TA1CCR1:
+            *(_display->digitsRegister) = 
+                (*(_display->digitsRegister) & ~(_display->_digitsMask)) 
+                | _display->_digitsOff;
+            break;
+    }
+}
+
+#endif // !MUX_SEVEN_SEG_C
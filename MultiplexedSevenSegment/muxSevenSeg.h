@@ -1,8 +1,93 @@
 #ifndef MUX_SEVEN_SEG
 #define MUX_SEVEN_SEG
 
+#include "io430f5529.h"
+#include "utility.h"
 #include "sevenSegment.h"
 
+
+#ifndef MUX_SEVEN_SEG_MAX_DIGITS
+/**
+ * @brief The maximum number of digits
+ * of a multiplexed display.
+ */
+#define MUX_SEVEN_SEG_MAX_DIGITS 8
+#endif // !MUX_SEVEN_SEG_MAX_DIGITS
+
+
+#ifndef MUX_SEVEN_SEG_BLANK_TICKS
+/**
+ * @brief The minimum number of timer ticks 
+ * in which all the digits are off before the 
+ * next digit is selected, so that it doesn't
+ * show the previous digit's segments (ghosting).
+ */
+#define MUX_SEVEN_SEG_BLANK_TICKS 16
+#endif // !MUX_SEVEN_SEG_BLANK_TICKS
+
+
+/**
+ * @brief The brightness of a fully lit digit.
+ */
+#define MUX_SEVEN_SEG_MAX_BRIGHTNESS 0xFF
+
+
+/**
+ * @brief A pre-encoded text scrolled through
+ * a display, or an animation: a sequence of 
+ * frames shown one after the other.
+ *
+ * The refresh interrupt moves the front frame 
+ * along the segments, so showing a new position 
+ * is a pointer advance.
+ */
+typedef struct MuxSevenSegText
+{
+    /**
+     * @brief The first and the last frames.
+     */
+    const byte* segments;
+    const byte* last;
+    
+    /**
+     * @brief The bytes between two frames:
+     * 1 to scroll, the number of digits
+     * for an animation.
+     */
+    byte step;
+    
+    /**
+     * @brief The display refreshes (frames)
+     * each position is shown for.
+     */
+    unsigned int rate;
+    
+    /**
+     * @brief Tells whether to start again
+     * after the last frame.
+     */
+    bool loop;
+    
+    unsigned int _countdown;
+    
+} MuxSevenSegText;
+
+
+/**
+ * @brief Holds informations about a 
+ * multiplexed seven segment display.
+ *
+ * The digits share the segments port and are 
+ * selected one at a time by the Timer A1 interrupt,
+ * which shows the pre-encoded segments of the 
+ * front frame.
+ * Frames are double buffered: the new frame is 
+ * only shown from the next refresh of the first digit.
+ *
+ * Each digit stays on for a part of its period 
+ * (Timer A1 CCR1), which sets its brightness, and 
+ * all the digits are off for the rest of it.
+ */
 typedef struct MuxSevenSegInfo 
 {
     /**
@@ -10,8 +95,299 @@ typedef struct MuxSevenSegInfo
      * segments.
      */
     SevenSegmentInfo* segmentInfo;
+    
+    /**
+     * @brief The port used to select the digits.
+     */
+    volatile unsigned char* digitsRegister;
+    
+    /**
+     * @brief The direction register of the
+     * digits' port.
+     */
+    volatile unsigned char* digitsDirRegister;
+    
+    /**
+     * @brief The number of digits.
+     */
+    byte digits;
+    
+    /**
+     * @brief The digits' pins on the digits port
+     * and the value of those pins to select each 
+     * digit or none.
+     */
+    byte _digitsMask;
+    byte _digitsOff;
+    byte _select[MUX_SEVEN_SEG_MAX_DIGITS];
+    
+    /**
+     * @brief How long each digit stays on,
+     * in timer ticks (TA1CCR1).
+     */
+    unsigned int _onTime[MUX_SEVEN_SEG_MAX_DIGITS];
+    
+    /**
+     * @brief The segments forced on and the ones
+     * kept (not forced off) for each digit, 
+     * applied over the frame.
+     */
+    byte _segmentsOn  [MUX_SEVEN_SEG_MAX_DIGITS];
+    byte _segmentsKeep[MUX_SEVEN_SEG_MAX_DIGITS];
+    
+    /**
+     * @brief The timer's period of each digit.
+     */
+    unsigned int _period;
+    
+    /**
+     * @brief The frame being shown and the one 
+     * that will replace it, NULL if none.
+     */
+    const byte* volatile _front;
+    const byte* volatile _pending;
+    
+    /**
+     * @brief The text or the animation being 
+     * played, NULL if none.
+     */
+    MuxSevenSegText* volatile _text;
+    
+    /**
+     * @brief The two frame buffers and the index 
+     * of the one not being shown.
+     */
+    byte _frames[2][MUX_SEVEN_SEG_MAX_DIGITS];
+    byte _back;
+    
+    /**
+     * @brief The digit refreshed by the 
+     * next interrupt.
+     */
+    byte _current;
   
 } MuxSevenSegInfo;
 
 
-#endif // !MUX_SEVEN_SEG
\ No newline at end of file
+/**
+ * @brief Allocates a MuxSevenSegInfo structure
+ * and returns a pointer to it, NULL if out of memory.
+ * All the digits are turned off.
+ *
+ * @param segmentInfo
+ *      The display's segments.
+ *
+ * @param digitsRegister
+ *      The port used to select the digits.
+ *
+ * @param digitsDirRegister
+ *      The direction register of the digits port.
+ *
+ * @param digitPins
+ *      The pin (BITx) of each digit, from the 
+ *      leftmost one.
+ *
+ * @param digits
+ *      The number of digits, up to 
+ *      MUX_SEVEN_SEG_MAX_DIGITS.
+ *
+ * @param activeLow
+ *      Tells whether a digit is selected by 
+ *      driving its pin low.
+ */
+MuxSevenSegInfo* createMuxSevenSegInfo(
+             SevenSegmentInfo* segmentInfo,
+             volatile unsigned char* digitsRegister,
+             volatile unsigned char* digitsDirRegister,
+             const byte* digitPins,
+             byte digits,
+             bool activeLow);
+
+
+/**
+ * @brief Starts refreshing a display with the
+ * Timer A1, one digit per interrupt.
+ * All the digits start at full brightness.
+ *
+ * @param ccr0Delay
+ *      The timer's period (SMCLK cycles) of each digit,
+ *      more than MUX_SEVEN_SEG_BLANK_TICKS.
+ */
+void muxSevenSegStart(MuxSevenSegInfo* muxInfo, unsigned int ccr0Delay);
+
+
+/**
+ * @brief Stops the refresh and turns 
+ * off the digits.
+ */
+void muxSevenSegStop(void);
+
+
+/**
+ * @brief Returns the frame buffer not being shown,
+ * where the next frame can be drawn.
+ * Waits in low power mode for the last swap
+ * to be applied, which takes at most a frame.
+ */
+byte* muxSevenSegBackBuffer(MuxSevenSegInfo* muxInfo);
+
+
+/**
+ * @brief Shows the back buffer from the 
+ * next frame.
+ */
+void muxSevenSegSwap(MuxSevenSegInfo* muxInfo);
+
+
+/**
+ * @brief Shows an external frame of pre-encoded
+ * segments from the next frame. 
+ * The frame must stay valid while shown.
+ */
+void muxSevenSegShow(MuxSevenSegInfo* muxInfo, const byte* frame);
+
+
+/**
+ * @brief Tells whether a frame is waiting 
+ * to be shown.
+ */
+#define MUX_SEVEN_SEG_SWAP_PENDING(muxInfo) \
+    ((muxInfo)->_pending != NULL)
+
+
+/**
+ * @brief Writes an hexadecimal number to the
+ * display, right aligned.
+ */
+void muxSevenSegWriteHex(MuxSevenSegInfo* muxInfo, unsigned long value);
+
+
+/**
+ * @brief Writes a signed decimal number to the
+ * display, right aligned and without leading zeros.
+ *
+ * @returns
+ *      False if the number doesn't fit.
+ */
+bool muxSevenSegWriteDec(MuxSevenSegInfo* muxInfo, long value);
+
+
+/**
+ * @brief Sets the brightness of a digit.
+ *
+ * @param digit
+ *      The digit, from the leftmost.
+ *
+ * @param brightness
+ *      From 0 (off) to MUX_SEVEN_SEG_MAX_BRIGHTNESS.
+ */
+void muxSevenSegBrightness(MuxSevenSegInfo* muxInfo, byte digit, byte brightness);
+
+
+/**
+ * @brief Sets the brightness of all the digits.
+ */
+void muxSevenSegBrightnessAll(MuxSevenSegInfo* muxInfo, byte brightness);
+
+
+/**
+ * @brief Forces some segments of a digit on or off,
+ * whatever frame is shown, without redrawing it.
+ *
+ * @param on
+ *      The segments to turn on.
+ *
+ * @param off
+ *      The segments to turn off.
+ */
+void muxSevenSegOverride(MuxSevenSegInfo* muxInfo, byte digit, byte on, byte off);
+
+
+/**
+ * @brief Turns the dot of a digit ON or OFF
+ * without redrawing the frame.
+ */
+#define MUX_SEVEN_SEG_DOT(muxInfo, digit, state)    \
+    muxSevenSegOverride(                            \
+        (muxInfo), (digit),                         \
+        (state) ? SEG_DOT : 0,                      \
+        (state) ? 0 : SEG_DOT)
+
+
+/**
+ * @brief Encodes a text to scroll it through a 
+ * display from right to left. Blanks as wide as 
+ * the display are added before and after it.
+ *
+ * @param text
+ *      The scroll to initialize.
+ *
+ * @param buffer
+ *      Holds the encoded text, must stay valid 
+ *      while the text is played.
+ *
+ * @param size
+ *      The size of buffer.
+ *
+ * @param string
+ *      The NULL terminated string to encode.
+ *
+ * @param rate
+ *      The display refreshes between two steps.
+ *
+ * @param loop
+ *      Tells whether to scroll the text again 
+ *      when it's over.
+ *
+ * @returns
+ *      The number of encoded bytes, 0 if 
+ *      the encoded text doesn't fit buffer
+ *      with a blank display on each side.
+ */
+unsigned int muxSevenSegTextInit(
+             MuxSevenSegInfo* muxInfo,
+             MuxSevenSegText* text,
+             byte* buffer,
+             unsigned int size,
+             const char* string,
+             unsigned int rate,
+             bool loop);
+
+
+/**
+ * @brief Initializes an animation from 
+ * consecutive frames as wide as the display.
+ *
+ * @param frames
+ *      The frames, must stay valid while 
+ *      the animation is played.
+ *
+ * @param count
+ *      The number of frames.
+ */
+void muxSevenSegAnimationInit(
+             MuxSevenSegInfo* muxInfo,
+             MuxSevenSegText* animation,
+             const byte* frames,
+             unsigned int count,
+             unsigned int rate,
+             bool loop);
+
+
+/**
+ * @brief Plays a text or an animation from 
+ * its first frame. 
+ * Showing or swapping another frame stops it.
+ */
+void muxSevenSegPlay(MuxSevenSegInfo* muxInfo, MuxSevenSegText* text);
+
+
+/**
+ * @brief Tells whether a text or an 
+ * animation is being played.
+ */
+#define MUX_SEVEN_SEG_PLAYING(muxInfo) \
+    ((muxInfo)->_text != NULL)
+
+
+#endif // !MUX_SEVEN_SEG
@@ -0,0 +1,86 @@
+#ifndef POWER_C
+#define POWER_C
+
+#include "power.h"
+
+
+volatile bool __powerWork = false;
+
+
+/**
+ * @brief The deepest mode tolerated by 
+ * each driver, any at the beginning.
+ */
+static volatile byte _limits[POWER_CLIENTS] =
+{
+    POWER_LPM4, POWER_LPM4, POWER_LPM4, POWER_LPM4,
+    POWER_LPM4, POWER_LPM4, POWER_LPM4
+};
+
+
+/**
+ * @brief The status register bits of each mode.
+ */
+static const uint _bits[] =
+{
+    0, LPM0_bits, LPM1_bits, LPM2_bits, LPM3_bits, LPM4_bits
+};
+
+
+void powerRequire(PowerClient client, PowerMode deepest)
+{
+    // The CPU may be sleeping deeper
+    if (deepest < _limits[client])
+        POWER_POST_WORK();
+    
+    _limits[client] = deepest;
+}
+
+
+PowerMode powerDeepest(void)
+{
+    register byte i;
+    byte result = POWER_LPM4;
+    
+    for (i = 0; i < POWER_CLIENTS; i++)
+        if (_limits[i] < result)
+            result = _limits[i];
+    
+    return (PowerMode)result;
+}
+
+
+void powerSleep(uint lpmBits)
+{
+    // An interrupt between the check and the 
+    // sleep would be missed: GIE is set by the 
+    // same instruction that stops the CPU
+    __disable_interrupt();
+    
+    if (!__powerWork && lpmBits != 0)
+    {
+        __bis_SR_register(lpmBits + GIE);
+        __no_operation();
+    }
+    
+    __powerWork = false;
+    __enable_interrupt();
+}
+
+
+void powerIdle(void)
+{
+    uint bits;
+    
+    // A limit changed by an interrupt 
+    // after this posts work
+    ATOMIC
+    (
+        bits = _bits[powerDeepest()];
+    );
+    
+    powerSleep(bits);
+}
+
+
+#endif // !POWER_C
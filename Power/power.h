@@ -0,0 +1,110 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "io430f5529.h"
+#include "utility.h"
+
+
+/**
+ * @brief The drivers that limit the low power 
+ * mode while they have pending work.
+ */
+typedef enum PowerClient
+{
+    POWER_SERIAL = 0x00,
+    POWER_TIMER,
+    POWER_ADC12,
+    POWER_I2C,
+    POWER_SPI,
+    POWER_DISPLAY,
+    POWER_DEBOUNCER,
+    POWER_CLIENTS
+} PowerClient;
+
+
+/**
+ * @brief The low power modes, from the lightest.
+ * POWER_ACTIVE never stops the CPU.
+ */
+typedef enum PowerMode
+{
+    POWER_ACTIVE = 0x00,
+    POWER_LPM0,             // SMCLK, ACLK
+    POWER_LPM1,
+    POWER_LPM2,
+    POWER_LPM3,             // ACLK only
+    POWER_LPM4              // No clocks
+} PowerMode;
+
+
+/**
+ * @brief Set by the interrupts when they post 
+ * work for the main loop, cleared by powerSleep.
+ */
+extern volatile bool __powerWork;
+
+
+/**
+ * @brief Tells the main loop that there's new 
+ * work. Can be used by the callbacks called
+ * from the interrupts.
+ */
+#define POWER_POST_WORK() \
+    (__powerWork = true)
+
+
+/**
+ * @brief Wakes the CPU when the interrupt
+ * returns if work has been posted.
+ * Must be used in the interrupt's body, 
+ * not in a function called by it.
+ */
+#define POWER_WAKE_ON_EXIT()                        \
+    {                                               \
+        if (__powerWork)                            \
+            __bic_SR_register_on_exit(LPM4_bits);   \
+    }
+
+
+/**
+ * @brief Sets the deepest mode a driver tolerates
+ * until it's released. Can be called from the 
+ * interrupts: a lighter mode posts work, so that
+ * the main loop sleeps again with the new limit.
+ */
+void powerRequire(PowerClient client, PowerMode deepest);
+
+
+/**
+ * @brief The driver has no pending work
+ * and tolerates any mode.
+ */
+#define powerRelease(client) \
+    powerRequire((client), POWER_LPM4)
+
+
+/**
+ * @brief Returns the deepest mode 
+ * tolerated by all the drivers.
+ */
+PowerMode powerDeepest(void);
+
+
+/**
+ * @brief Enters the given low power mode 
+ * (LPMx_bits) until an interrupt posts work.
+ * Returns immediately if work has been posted
+ * since the last call.
+ */
+void powerSleep(uint lpmBits);
+
+
+/**
+ * @brief Like powerSleep, in the deepest mode 
+ * tolerated by the drivers. 
+ * Used by the drivers while they wait.
+ */
+void powerIdle(void);
+
+
+#endif // !POWER_H
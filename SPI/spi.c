@@ -0,0 +1,209 @@
+#include "spi.h"
+#include "power.h"
+
+
+/**
+ * @brief The source of the fill bytes 
+ * and the destination of the discarded ones.
+ */
+static const byte _fill = SPI_FILL_BYTE;
+static byte _discard;
+
+
+static void _start(SpiTransaction *transaction);
+static void _completed(void);
+
+
+SpiPort Spi =
+{
+    &_spiBegin,
+    &_spiClose,
+
+    &_spiTransferAsync,
+    &_spiTransfer,
+    &_spiWait,
+
+    &_spiTransferByte,
+    &_spiIsBusy,
+    
+    NULL,
+    NULL
+};
+
+
+void _spiBegin(uint prescaler, SpiMode mode)
+{
+    // P4.1,2,3 = USCI_B1 SIMO/SOMI/CLK
+    P4SEL |= BIT1 + BIT2 + BIT3;
+
+    SPI_RESET
+    (
+        UCB1CTL0  = UCMST + UCSYNC + UCMSB + mode;
+        UCB1CTL1 |= UCSSEL_2; // SMCLK
+        
+        UCB1BR0 = (byte)prescaler;
+        UCB1BR1 = prescaler >> 8;
+    );
+
+    dmaSetTrigger(SPI_DMA_RX_CHANNEL, DMA_TRIGGER_UCB1_RX);
+    dmaSetTrigger(SPI_DMA_TX_CHANNEL, DMA_TRIGGER_UCB1_TX);
+    dmaSetCallback(SPI_DMA_RX_CHANNEL, &_completed);
+}
+
+
+void _spiClose(void)
+{
+    while (_spiIsBusy())
+        powerIdle();
+    
+    UCB1CTL1 |= UCSWRST;
+    P4SEL    &= ~(BIT1 + BIT2 + BIT3);
+}
+
+
+bool _spiTransferAsync(SpiTransaction *transaction)
+{
+    if (transaction->status == SPI_PENDING)
+        return false;
+    
+    transaction->status = SPI_PENDING;
+    transaction->_next  = NULL;
+    
+    // With the check of the queue: the transaction
+    // running may end and release the clock
+    ATOMIC
+    (
+        powerRequire(POWER_SPI, POWER_LPM0);
+        
+        if (Spi._head == NULL)
+        {
+            Spi._head = Spi._tail = transaction;
+            _start(transaction);
+        }
+        else
+        {
+            Spi._tail->_next = transaction;
+            Spi._tail = transaction;
+        }
+    );
+    
+    return true;
+}
+
+
+inline void _spiTransfer(SpiTransaction *transaction)
+{
+    _spiTransferAsync(transaction);
+    _spiWait(transaction);
+}
+
+
+inline void _spiWait(SpiTransaction *transaction)
+{
+    // Woken by the end of the transfers
+    while (transaction->status == SPI_PENDING)
+        powerIdle();
+}
+
+
+byte _spiTransferByte(const byte data)
+{
+    while (!(UCB1IFG & UCTXIFG))
+        ;
+    
+    UCB1TXBUF = data;
+    
+    while (!(UCB1IFG & UCRXIFG))
+        ;
+    
+    return UCB1RXBUF;
+}
+
+
+inline bool _spiIsBusy(void)
+{
+    return Spi._head != NULL;
+}
+
+
+/**
+ * @brief Selects the slave and starts the DMA 
+ * transfers, or ends an empty transaction.
+ */
+static void _start(SpiTransaction *transaction)
+{
+    const byte *tx = transaction->txData;
+    byte       *rx = transaction->rxData;
+    
+    *transaction->csPort &= ~transaction->csPin;
+    
+    if (transaction->length == 0)
+    {
+        _completed();
+        return;
+    }
+    
+    // A byte left by transferByte 
+    // would trigger the receiving channel
+    _discard = UCB1RXBUF;
+    
+    DMA_START(
+        SPI_DMA_RX_CHANNEL,
+        &UCB1RXBUF,
+        rx != NULL ? rx : &_discard,
+        transaction->length,
+        DMASRCINCR_0 + (rx != NULL ? DMADSTINCR_3 : DMADSTINCR_0));
+    
+    // The DMA only sees the rising edges of UCTXIFG, 
+    // which is already set: the first byte is written 
+    // here and the channel sends the others
+    if (transaction->length > 1)
+    {
+        DMA_START(
+            SPI_DMA_TX_CHANNEL,
+            tx != NULL ? tx + 1 : &_fill,
+            &UCB1TXBUF,
+            transaction->length - 1,
+            (tx != NULL ? DMASRCINCR_3 : DMASRCINCR_0) + DMADSTINCR_0);
+        
+        // Only the receiving channel ends the transfer
+        DMA_REGISTER(SPI_DMA_TX_CHANNEL, CTL) &= ~DMAIE;
+    }
+    
+    UCB1TXBUF = tx != NULL ? tx[0] : _fill;
+}
+
+
+/**
+ * @brief Called when the last byte has been 
+ * received: the transfer is over on the bus.
+ * Ends the running transaction and starts 
+ * the next one.
+ */
+static void _completed(void)
+{
+    SpiTransaction* transaction = Spi._head;
+    SpiTransaction* next        = transaction->_next;
+    
+    if (!transaction->keepSelected)
+        *transaction->csPort |= transaction->csPin;
+    
+    Spi._head = next;
+    if (next == NULL)
+        Spi._tail = NULL;
+    
+    transaction->status = SPI_DONE;
+    
+    if (transaction->completed != NULL)
+        transaction->completed(transaction);
+    
+    POWER_POST_WORK();
+    
+    // A transaction submitted by the callback 
+    // to an empty queue has already started
+    if (next != NULL)
+        _start(next);
+    
+    else if (Spi._head == NULL)
+        powerRelease(POWER_SPI);
+}
@@ -0,0 +1,223 @@
+#ifndef SPI_H_
+#define SPI_H_
+
+#include "io430f5529.h"
+#include "utility.h"
+#include "dma.h"
+
+
+#ifndef SPI_DMA_RX_CHANNEL
+/**
+ * @brief 
+ * The DMA channels of the SPI transfers.
+ * The receiving one must have the higher
+ * priority (lower number), so that no byte 
+ * is overwritten before it's read.
+ */
+#define SPI_DMA_RX_CHANNEL 1
+#define SPI_DMA_TX_CHANNEL 2
+#endif // !SPI_DMA_RX_CHANNEL
+
+
+/**
+ * @brief 
+ * The byte sent when a transfer only reads.
+ */
+#define SPI_FILL_BYTE 0xFF
+
+
+/**
+ * @brief 
+ * The clock polarity (CPOL) and phase (CPHA) 
+ * modes, as UCB1CTL0 flags.
+ */
+typedef enum SpiMode
+{
+    SPI_MODE_0 = UCCKPH,            // CPOL 0, CPHA 0
+    SPI_MODE_1 = 0,                 // CPOL 0, CPHA 1
+    SPI_MODE_2 = UCCKPL + UCCKPH,   // CPOL 1, CPHA 0
+    SPI_MODE_3 = UCCKPL             // CPOL 1, CPHA 1
+} SpiMode;
+
+
+/**
+ * @brief 
+ * The state of a transaction.
+ */
+typedef enum SpiStatus
+{
+    SPI_DONE = 0x00,
+    SPI_PENDING
+} SpiStatus;
+
+
+struct SpiTransaction;
+
+typedef void (*SpiCallback)(struct SpiTransaction* transaction);
+
+
+/**
+ * @brief 
+ * A full-duplex transfer with a slave: length 
+ * bytes are sent while length bytes are received,
+ * with the slave's chip select (active low) driven 
+ * low for the whole transfer.
+ *
+ * The struct and its buffers are owned by the driver
+ * until the status is no longer SPI_PENDING.
+ * Must be zero-initialized before the first use.
+ */
+typedef struct SpiTransaction
+{
+    /**
+     * @brief 
+     * The output register and the pin (BITx) 
+     * of the chip select, which must already be 
+     * an output driven high.
+     */
+    Register *csPort;
+    byte      csPin;
+    
+    /**
+     * @brief 
+     * Keeps the slave selected after the transfer,
+     * for the next one (e.g. a command followed by 
+     * the data). The next transaction must be 
+     * submitted from the callback.
+     */
+    bool keepSelected;
+    
+    /**
+     * @brief 
+     * The bytes to send, SPI_FILL_BYTE if NULL.
+     */
+    const byte *txData;
+    
+    /**
+     * @brief 
+     * The received bytes, discarded if NULL.
+     */
+    byte *rxData;
+    
+    uint length;
+    
+    /**
+     * @brief 
+     * Called from the interrupt when the
+     * transfer is over. Can be NULL.
+     */
+    SpiCallback completed;
+    
+    /**
+     * @brief 
+     * Optional data for the callback.
+     */
+    void *context;
+    
+    volatile SpiStatus status;
+    
+//\
+Private:
+    struct SpiTransaction *_next;
+    
+} SpiTransaction;
+
+
+/**
+ * @brief 
+ * Execute the given code while
+ * the USCI interface is in reset
+ * mode.
+ */
+#define SPI_RESET(expr)         \
+    {                           \
+        UCB1CTL1 |= UCSWRST;    \
+        expr                    \
+        UCB1CTL1 &= ~UCSWRST;   \
+    }
+
+
+typedef struct SpiPort
+{ 
+//\
+Public:
+
+    /**
+     * @brief 
+     * Initializes the USCI_B1 as SPI master, 
+     * MSB first (P4.1 SIMO, P4.2 SOMI, P4.3 CLK).
+     * 
+     * @param prescaler: The SMCLK divider of the clock.
+     * @param mode:      The clock polarity and phase.
+     */
+    void (*const begin)(uint prescaler, SpiMode mode);
+
+    /**
+     * @brief 
+     * Stops the interface, waiting for 
+     * the queued transfers.
+     */
+    void (*const close)(void);
+
+    /**
+     * @brief 
+     * Queues a transfer, which is moved by 
+     * the DMA as soon as the previous ones 
+     * are over.
+     * 
+     * @returns:
+     *      False if the transaction is still pending.
+     */
+    bool (*const transferAsync)(SpiTransaction *transaction);
+
+    /**
+     * @brief 
+     * Queues a transfer and blocks 
+     * until it's over.
+     */
+    void (*const transfer)(SpiTransaction *transaction);
+
+    /**
+     * @brief 
+     * Blocks until a transfer is over.
+     */
+    void (*const wait)(SpiTransaction *transaction);
+
+    /**
+     * @brief 
+     * Sends a byte and returns the received one,
+     * without DMA nor chip select.
+     * The interface must not be busy.
+     */
+    byte (*const transferByte)(const byte data);
+
+    /**
+     * @brief 
+     * Tells whether there are transfers
+     * running or queued.
+     */
+    bool (*const isBusy)(void);
+
+//\
+Private:
+    SpiTransaction* volatile _head;
+    SpiTransaction* volatile _tail;
+
+} SpiPort;
+
+
+void _spiBegin(uint prescaler, SpiMode mode);
+void _spiClose(void);
+
+bool _spiTransferAsync(SpiTransaction *transaction);
+void _spiTransfer     (SpiTransaction *transaction);
+void _spiWait         (SpiTransaction *transaction);
+
+byte _spiTransferByte(const byte data);
+bool _spiIsBusy(void);
+
+
+extern SpiPort Spi;
+
+
+#endif // !SPI_H_
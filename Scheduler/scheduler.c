@@ -0,0 +1,115 @@
+#ifndef SCHEDULER_C
+#define SCHEDULER_C
+
+#include "scheduler.h"
+#include "power.h"
+
+
+/**
+ * @brief The tasks, the last added first.
+ */
+static Task* volatile _tasks = NULL;
+
+
+static void _tick(void);
+
+
+bool initScheduler(void)
+{
+    TimerInfo* tick = createTimerInfo(0, true, &_tick);
+    
+    if (tick == NULL)
+        return false;
+    
+    if (!addManagedTimer(tick))
+    {
+        memFree(tick);
+        return false;
+    }
+    
+    return true;
+}
+
+
+void schedulerAdd(Task* task, TaskFunction run, void* context)
+{
+    task->run     = run;
+    task->context = context;
+    task->result  = 0;
+    task->_line     = 0;
+    task->_progress = false;
+    task->_sleep    = 0;
+    task->_next   = _tasks;
+    
+    // The tick sees it once linked
+    _tasks = task;
+}
+
+
+bool schedulerStep(void)
+{
+    register Task* task;
+    Task* previous = NULL;
+    bool progress  = false;
+    
+    for (task = _tasks; task != NULL; task = task->_next)
+    {
+        TaskStatus status;
+        
+        task->_progress = false;
+        status = task->run(task);
+        
+        // An await passed also counts, even if the 
+        // task is now waiting again
+        if (status != TASK_WAITING || task->_progress)
+            progress = true;
+        
+        if (status != TASK_EXITED)
+        {
+            previous = task;
+            continue;
+        }
+        
+        // Unlinked: its next pointer stays 
+        // valid for the tick and this loop
+        ATOMIC
+        (
+            if (previous == NULL)
+                _tasks = task->_next;
+            else
+                previous->_next = task->_next;
+        );
+    }
+    
+    return progress;
+}
+
+
+void schedulerRun(void)
+{
+    while (true)
+    {
+        if (!schedulerStep())
+            powerIdle();
+        
+        collectManagedTimers();
+    }
+}
+
+
+/**
+ * @brief Called by the Timer interrupt at every tick.
+ */
+static void _tick(void)
+{
+    register Task* task;
+    
+    for (task = _tasks; task != NULL; task = task->_next)
+    {
+        if (task->_sleep != 0 && --(task->_sleep) == 0)
+            POWER_POST_WORK();
+    }
+}
+
+
+#endif // !SCHEDULER_C
@@ -0,0 +1,189 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "utility.h"
+#include "timer.h"
+#include "serial.h"
+#include "adc12.h"
+
+
+/**
+ * @brief What a task returned.
+ */
+typedef enum TaskStatus
+{
+    TASK_WAITING = 0x00,
+    TASK_YIELDED,
+    TASK_EXITED
+} TaskStatus;
+
+
+struct Task;
+
+typedef TaskStatus (*TaskFunction)(struct Task* task);
+
+
+/**
+ * @brief 
+ * A stackless coroutine (protothread): its function 
+ * is called again and again by the scheduler, and 
+ * continues from the await it returned at.
+ *
+ * The function's local variables are lost at every 
+ * await, the ones to keep must be in the context or 
+ * static. A switch can't contain an await.
+ *
+ * TaskStatus blink(Task* task)
+ * {
+ *     TASK_BEGIN(task);
+ *     while (true)
+ *     {
+ *         SWITCH_PORT(P1OUT, BIT0);
+ *         TASK_SLEEP(task, 500);
+ *     }
+ *     TASK_END(task);
+ * }
+ */
+typedef struct Task
+{
+    TaskFunction run;
+    
+    /**
+     * @brief Optional data for the task.
+     */
+    void* context;
+    
+    /**
+     * @brief The result of the last await 
+     * that has one (line length, conversion).
+     */
+    uint result;
+    
+//\
+Private:
+    uint _line;
+    
+    /**
+     * @brief Set when the task reaches an await
+     * by running, not by being resumed there.
+     */
+    bool _progress;
+    
+    /**
+     * @brief The ticks left to sleep, 
+     * decremented by the timer interrupt.
+     */
+    volatile uint _sleep;
+    
+    struct Task* volatile _next;
+    
+} Task;
+
+
+/**
+ * @brief Must be the first statement of a task.
+ */
+#define TASK_BEGIN(task) \
+    switch ((task)->_line) { case 0:
+
+
+/**
+ * @brief Must be the last statement of a task:
+ * reaching it removes the task.
+ */
+#define TASK_END(task)              \
+    }                               \
+    (task)->_line = 0;              \
+    return TASK_EXITED;
+
+
+/**
+ * @brief Returns until the condition is true.
+ */
+#define TASK_AWAIT_UNTIL(task, condition)       \
+    (task)->_line     = __LINE__;               \
+    (task)->_progress = true;                   \
+    case __LINE__:                              \
+    if (!(condition))                           \
+        return TASK_WAITING;
+
+
+/**
+ * @brief Lets the other tasks run, the 
+ * task continues in the next round.
+ */
+#define TASK_YIELD(task)                        \
+    (task)->_line = __LINE__;                   \
+    return TASK_YIELDED;                        \
+    case __LINE__:
+
+
+/**
+ * @brief Returns until the given number of 
+ * Timer ticks have elapsed.
+ */
+#define TASK_SLEEP(task, ticks)                 \
+    (task)->_sleep = (ticks);                   \
+    TASK_AWAIT_UNTIL(task, (task)->_sleep == 0)
+
+
+/**
+ * @brief Returns until a line ending with terminator
+ * is read from the Serial, or the buffer is full.
+ * The length, terminator excluded, is stored in the 
+ * task's result.
+ */
+#define TASK_AWAIT_LINE(task, buffer, size, terminator)     \
+    (task)->result = 0;                                     \
+    TASK_AWAIT_UNTIL(task,                                  \
+        Serial.readUntilAsync(                              \
+            (buffer), (size), (terminator), &(task)->result))
+
+
+/**
+ * @brief Starts an ADC12 conversion and returns 
+ * until it's over. The raw value is stored in 
+ * the task's result.
+ * A conversion can only be awaited by one task 
+ * at a time.
+ */
+#define TASK_AWAIT_CONVERSION(task) \
+    TASK_AWAIT_UNTIL(task, adc12GetRawAsync(&(task)->result))
+
+
+/**
+ * @brief Adds the tick of the sleeps to the 
+ * Timer's managed timers. 
+ * The Timer must be initialized.
+ *
+ * @returns
+ *      False if out of memory.
+ */
+bool initScheduler(void);
+
+
+/**
+ * @brief Adds a task, which starts from the 
+ * beginning at the next round.
+ */
+void schedulerAdd(Task* task, TaskFunction run, void* context);
+
+
+/**
+ * @brief Runs every task once.
+ *
+ * @returns
+ *      False if every task is waiting.
+ */
+bool schedulerStep(void);
+
+
+/**
+ * @brief Runs the tasks forever, in the deepest 
+ * low power mode tolerated by the drivers when 
+ * every task is waiting for an interrupt.
+ */
+void schedulerRun(void);
+
+
+#endif // !SCHEDULER_H
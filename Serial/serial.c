@@ -1,5 +1,52 @@
 #include "serial.h"
+#include "power.h"
+#include "trace.h"
 #include <math.h>
+#include <string.h>
+
+
+#if SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+
+/**
+ * @brief The rx watermarks, in bytes: 
+ * computed once by begin.
+ */
+static uint _rxHigh;
+static uint _rxLow;
+
+/**
+ * @brief Set while the other end is stopped.
+ */
+static volatile bool _rxStopped = false;
+
+#endif // SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_XON_XOFF
+
+/**
+ * @brief The XON or XOFF to send
+ * before the data, 0 if none.
+ */
+static volatile byte _control = 0;
+
+/**
+ * @brief Set by a received XOFF.
+ */
+static volatile bool _txPaused = false;
+
+#endif // SERIAL_FLOW_CONTROL == SERIAL_FLOW_XON_XOFF
+
+
+static uint _txLow;
+
+static SerialErrors _errors;
+
+
+static inline void _flowStop(void);
+static inline void _flowResume(void);
+static inline bool _flowReceive(byte data);
+static inline bool _flowTransmit(void);
 
 
 inline void computeUCBR(
@@ -25,6 +72,7 @@ inline void computeUCBR(
 SerialPort Serial =
 {
     16,
+    NULL,
     &_begin,
     &_close,
 
@@ -39,7 +87,8 @@ SerialPort Serial =
 
     &_writeBuff,
     &_writeBuffAsync,
-    &_readUntil
+    &_readUntil,
+    &_readUntilAsync
 };
 
 
@@ -53,6 +102,7 @@ void _begin(BaudRate baudRate)
     SERIAL_RESET
     (
         UCA1CTL1 |= UCSSEL_2; // SMCLK
+        UCA1CTL1 |= UCRXEIE;  // The bytes with errors too, to count them
         UCA1MCTL |= UCBRF_0;  // Modulation UCBRFx=0
         
         // Baud rate
@@ -61,15 +111,54 @@ void _begin(BaudRate baudRate)
         UCA1MCTL |= (byte)baudRate;
     );
 
-    SERIAL_ENABLE_RX();
+    // Without buffers the port stays disabled
+    if (!cbInit(&Serial._tx, Serial.buffSize) ||
+        !cbInit(&Serial._rx, Serial.buffSize))
+        return;
+
+    _txLow = SERIAL_TX_LOW_WATERMARK(Serial.buffSize);
+    memset(&_errors, 0, sizeof(_errors));
+
+#if SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+    _rxHigh    = SERIAL_RX_HIGH_WATERMARK(Serial.buffSize);
+    _rxLow     = SERIAL_RX_LOW_WATERMARK(Serial.buffSize);
+    _rxStopped = false;
+#endif
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_XON_XOFF
+    _control  = 0;
+    _txPaused = false;
+#endif
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+    // RTS asserted
+    SERIAL_RTS_OUT &= ~SERIAL_RTS_BIT;
+    SERIAL_RTS_DIR |=  SERIAL_RTS_BIT;
 
-    cbInit(&Serial._tx, Serial.buffSize);
-    cbInit(&Serial._rx, Serial.buffSize);
+    // CTS asserted again: high-to-low edge
+    SERIAL_CTS_DIR &= ~SERIAL_CTS_BIT;
+    SERIAL_CTS_IES |=  SERIAL_CTS_BIT;
+    SERIAL_CTS_IFG &= ~SERIAL_CTS_BIT;
+    SERIAL_CTS_IE  |=  SERIAL_CTS_BIT;
+#endif
+
+    // A byte can be received at any time
+    powerRequire(POWER_SERIAL, POWER_LPM0);
+
+    SERIAL_ENABLE_RX();
 }
 
 
 inline void _close()
 {
+    SERIAL_DISABLE_RX();
+    SERIAL_DISABLE_TX();
+    powerRelease(POWER_SERIAL);
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+    SERIAL_CTS_IE &= ~SERIAL_CTS_BIT;
+#endif
+
     cbFree(&Serial._tx);
     cbFree(&Serial._rx);
 }
@@ -77,14 +166,19 @@ inline void _close()
 
 inline bool _readCharAsync(byte *data)
 {
-    return cbRead(&Serial._rx, data);
+    if (!cbRead(&Serial._rx, data))
+        return false;
+
+    _flowResume();
+    return true;
 }
 
 
 inline void _readChar(byte *data)
 {
+    // Woken by the received bytes
     while (!_readCharAsync(data))
-        ;
+        powerIdle();
 }
 
 
@@ -109,12 +203,13 @@ bool _writeCharAsync(const byte data)
 
 void _writeChar(const byte data)
 {
+    // Woken when the tx buffer is empty
     while (!_writeCharAsync(data))
-        ;
+        powerIdle();
 
     // Waiting for byte to be sent.
     while(!SERIAL_TX_AVAILABLE())
-        ;
+        powerIdle();
 }
 
 
@@ -140,7 +235,7 @@ uint _writeAsync(const byte *data)
 
 inline void _writeBuff(const byte *data, uint length)
 {
-    while(length > 0)
+    for (; length > 0; --length)
         _writeChar(*data++);
 }
 
@@ -175,26 +270,235 @@ uint _readUntil(
 }
 
 
+bool _readUntilAsync(
+    byte       *buffer, 
+    uint        size, 
+    const byte  terminator,
+    uint       *length)
+{
+    byte data;
+    while (*length < size && _readCharAsync(&data))
+    {
+        buffer[*length] = data;
+        if (data == terminator)
+            return true;
+
+        (*length)++;
+    }
+
+    return *length >= size;
+}
+
+
 #pragma vector = USCI_A1_VECTOR
 __interrupt void __serial_interrupt(void)
 {
     static byte data;
+    
+    TRACE_ISR_ENTER(TRACE_SERIAL);
   
     // Reading
-    if(SERIAL_DATA_RECEIVED())                    
-        cbWrite(&Serial._rx, UCA1RXBUF);
+    if(SERIAL_DATA_RECEIVED())
+    {
+        // Reading UCA1RXBUF clears the error flags
+        byte status = UCA1STAT;
+        data        = UCA1RXBUF;
+
+        if (status & UCOE)
+            _errors.overruns++;
+
+        if (status & UCFE)
+            _errors.framingErrors++;
+
+        // XON and XOFF aren't data
+        else if (!_flowReceive(data))
+        {
+            if (cbWrite(&Serial._rx, data))
+            {
+                RAISE_EVENT(Serial.received);
+                _flowStop();
+            }
+
+            else
+                _errors.dropped++;
+        }
+
+        POWER_POST_WORK();
+    }
 
     // Writing
-    if(SERIAL_TX_AVAILABLE() && SERIAL_TX_ENABLED())
+    if(SERIAL_TX_AVAILABLE() && SERIAL_TX_ENABLED() && !_flowTransmit())
     {	
     	if(cbIsEmpty(&Serial._tx)) 
         {
             SERIAL_DISABLE_TX();
-            return;
+            POWER_POST_WORK();
+        }
+
+        else
+        {
+            // Data to send
+    	    cbRead(&Serial._tx, &data);
+            UCA1TXBUF = data;
+
+            // The writers refill it
+            if (Serial._tx.count == _txLow)
+                POWER_POST_WORK();
+        }
+    }
+
+    TRACE_ISR_EXIT(TRACE_SERIAL);
+    POWER_WAKE_ON_EXIT();
+}
+
+
+void serialGetErrors(SerialErrors *errors, bool reset)
+{
+    // Also counted by the interrupt
+    ATOMIC
+    (
+        if (errors != NULL)
+            *errors = _errors;
+
+        if (reset)
+            memset(&_errors, 0, sizeof(_errors));
+    );
+}
+
+
+/**
+ * @brief 
+ * Stops the other end once the rx buffer
+ * reaches the high watermark. 
+ * From the interrupt.
+ */
+static inline void _flowStop(void)
+{
+#if SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+    if (_rxStopped || Serial._rx.count < _rxHigh)
+        return;
+
+    _rxStopped = true;
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+    SERIAL_RTS_OUT |= SERIAL_RTS_BIT;
+#else
+    _control = SERIAL_XOFF;
+    SERIAL_ENABLE_TX();
+#endif
+
+#endif // SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+}
+
+
+/**
+ * @brief 
+ * Resumes the other end once the rx buffer
+ * is down to the low watermark.
+ * After each byte read.
+ */
+static inline void _flowResume(void)
+{
+#if SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+    if (!_rxStopped)
+        return;
+
+    ATOMIC
+    (
+        if (_rxStopped && Serial._rx.count <= _rxLow)
+        {
+            _rxStopped = false;
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+            SERIAL_RTS_OUT &= ~SERIAL_RTS_BIT;
+#else
+            _control = SERIAL_XON;
+            SERIAL_ENABLE_TX();
+#endif
         }
+    );
+#endif // SERIAL_FLOW_CONTROL != SERIAL_FLOW_NONE
+}
+
+
+/**
+ * @brief 
+ * Handles a received XON or XOFF.
+ * 
+ * @returns
+ *      True if the byte was one of them,
+ *      not data.
+ */
+static inline bool _flowReceive(byte data)
+{
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_XON_XOFF
+    if (data == SERIAL_XOFF)
+    {
+        _txPaused = true;
+        return true;
+    }
+
+    if (data == SERIAL_XON)
+    {
+        _txPaused = false;
+        SERIAL_ENABLE_TX();
+        return true;
+    }
+#endif
+
+    return false;
+}
 
-        // Data to send
-    	cbRead(&Serial._tx, &data);
-        UCA1TXBUF = data;
+
+/**
+ * @brief 
+ * Sends the pending XON or XOFF, or stops the 
+ * transmission while the other end can't receive:
+ * an XON or the CTS interrupt restarts it.
+ * 
+ * @returns
+ *      True if the data must wait.
+ */
+static inline bool _flowTransmit(void)
+{
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_XON_XOFF
+    if (_control != 0)
+    {
+        UCA1TXBUF = _control;
+        _control  = 0;
+        return true;
+    }
+
+    if (_txPaused)
+    {
+        SERIAL_DISABLE_TX();
+        return true;
     }
-}
\ No newline at end of file
+#elif SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+    if (SERIAL_CTS_IN & SERIAL_CTS_BIT)
+    {
+        SERIAL_DISABLE_TX();
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+
+#pragma vector = SERIAL_CTS_VECTOR
+__interrupt void __serial_cts_interrupt(void)
+{
+    TRACE_ISR_ENTER(TRACE_SERIAL);
+
+    SERIAL_CTS_IFG &= ~SERIAL_CTS_BIT;
+
+    // The other end accepts data again
+    SERIAL_ENABLE_TX();
+
+    TRACE_ISR_EXIT(TRACE_SERIAL);
+}
+
+#endif // SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
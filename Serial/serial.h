@@ -60,6 +60,126 @@ typedef enum BaudRate
     }
 
 
+/*
+ * The flow control modes (SERIAL_FLOW_CONTROL).
+ */
+#define SERIAL_FLOW_NONE     0
+#define SERIAL_FLOW_RTS_CTS  1
+#define SERIAL_FLOW_XON_XOFF 2
+
+
+#ifndef SERIAL_FLOW_CONTROL
+/**
+ * @brief 
+ * How the other end is paused when the rx buffer
+ * fills up, and pauses the transmission in turn:
+ * - SERIAL_FLOW_RTS_CTS: the RTS output and the CTS
+ *   input, both active low GPIOs.
+ * - SERIAL_FLOW_XON_XOFF: the XON and XOFF characters,
+ *   which then can't be sent as data.
+ */
+#define SERIAL_FLOW_CONTROL SERIAL_FLOW_NONE
+#endif // !SERIAL_FLOW_CONTROL
+
+
+#ifndef SERIAL_RX_HIGH_WATERMARK
+/**
+ * @brief 
+ * The bytes in the rx buffer that stop the other end,
+ * from the buffer size: the rest is room for the
+ * bytes already on their way.
+ */
+#define SERIAL_RX_HIGH_WATERMARK(size) ((size) - ((size) >> 2))
+#endif // !SERIAL_RX_HIGH_WATERMARK
+
+
+#ifndef SERIAL_RX_LOW_WATERMARK
+/**
+ * @brief 
+ * The bytes left in the rx buffer when
+ * the other end is resumed.
+ */
+#define SERIAL_RX_LOW_WATERMARK(size) ((size) >> 2)
+#endif // !SERIAL_RX_LOW_WATERMARK
+
+
+#ifndef SERIAL_TX_LOW_WATERMARK
+/**
+ * @brief 
+ * The bytes left in the tx buffer when the writers
+ * waiting for room are woken: they refill it before
+ * it runs dry, without gaps on the line.
+ */
+#define SERIAL_TX_LOW_WATERMARK(size) ((size) >> 2)
+#endif // !SERIAL_TX_LOW_WATERMARK
+
+
+#define SERIAL_XON  0x11
+#define SERIAL_XOFF 0x13
+
+
+#if SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+
+#ifndef SERIAL_RTS_BIT
+/**
+ * @brief 
+ * The RTS output, low while the
+ * rx buffer has room.
+ */
+#define SERIAL_RTS_OUT  P2OUT
+#define SERIAL_RTS_DIR  P2DIR
+#define SERIAL_RTS_BIT  BIT4
+#endif // !SERIAL_RTS_BIT
+
+
+#ifndef SERIAL_CTS_BIT
+/**
+ * @brief 
+ * The CTS input, low while the other end accepts
+ * data: on P1 or P2, its edge interrupt resumes 
+ * the transmission. That port vector belongs to 
+ * Serial then, edgeDebouncer can't be linked.
+ */
+#define SERIAL_CTS_IN     P2IN
+#define SERIAL_CTS_DIR    P2DIR
+#define SERIAL_CTS_IES    P2IES
+#define SERIAL_CTS_IE     P2IE
+#define SERIAL_CTS_IFG    P2IFG
+#define SERIAL_CTS_BIT    BIT5
+#define SERIAL_CTS_VECTOR PORT2_VECTOR
+#endif // !SERIAL_CTS_BIT
+
+#endif // SERIAL_FLOW_CONTROL == SERIAL_FLOW_RTS_CTS
+
+
+/**
+ * @brief 
+ * The receive errors counted by the
+ * interrupt, see serialGetErrors.
+ */
+typedef struct SerialErrors
+{
+    /**
+     * @brief A byte was received before the previous
+     * one was read: the previous one is lost.
+     */
+    uint overruns;
+
+    /**
+     * @brief Bytes without their stop bit,
+     * discarded.
+     */
+    uint framingErrors;
+
+    /**
+     * @brief Bytes discarded because
+     * the rx buffer was full.
+     */
+    uint dropped;
+
+} SerialErrors;
+
+
 /**
  * @brief 
  * Computes the UCBRSx and UCBRx values
@@ -92,6 +212,13 @@ Public:
      */
     uint buffSize;
 
+    /**
+     * @brief 
+     * Called by the interrupt after each byte
+     * stored in the rx buffer, NULL if unused.
+     */
+    Action received;
+
     /**
      * @brief 
      * Initializes the serial port.
@@ -223,6 +350,29 @@ Public:
         uint        size, 
         const byte  terminator);
 
+    /**
+     * @brief 
+     * Reads the received bytes until it finds the 
+     * given token, without blocking: called again 
+     * it continues the same line.
+     * 
+     * @param buffer:     The buffer that will hold the message.
+     * @param size:       The size of the given buffer.
+     * @param terminator: The token used as line terminator.
+     * @param length:     
+     *      The bytes read so far, 0 to start a new line.
+     *      When done, the length of the line without 
+     *      the terminator.
+     * @returns:
+     *      True if the terminator was read 
+     *      or the buffer is full.
+     */
+    bool (*const readUntilAsync)(
+        byte       *buffer, 
+        uint        size, 
+        const byte  terminator,
+        uint       *length);
+
 //\
 Private:
     CircularBuffer _tx;
@@ -250,6 +400,19 @@ uint _readUntil(
     byte       *buffer, 
     uint        size, 
     const byte  terminator);
+bool _readUntilAsync(
+    byte       *buffer, 
+    uint        size, 
+    const byte  terminator,
+    uint       *length);
+
+
+/**
+ * @brief 
+ * Copies the receive errors counted so far,
+ * and clears them if reset is true.
+ */
+void serialGetErrors(SerialErrors *errors, bool reset);
 
 
 extern SerialPort Serial;
@@ -0,0 +1,326 @@
+#ifndef SERIAL_FORMAT_C
+#define SERIAL_FORMAT_C
+
+#include <stdarg.h>
+#include "serialFormat.h"
+#include "bcd.h"
+#include "power.h"
+
+
+static const char _digits[] = "0123456789ABCDEF";
+
+/**
+ * @brief The write index of the tx buffer
+ * when the field was reserved.
+ */
+static uint _start;
+
+
+static bool _reserve(uint length);
+static void _putAt(uint offset, byte data);
+static void _commit(uint length);
+static byte _nibbles(ulong low, ulong high);
+static bool _text(const char* data, uint length);
+static bool _number(
+    unsigned long long nibbles,
+    byte               minDigits,
+    byte               decimals,
+    bool               negative,
+    byte               width,
+    char               pad);
+
+
+bool serialPrintUInt(ulong value, byte width, char pad)
+{
+    return _number(binToBcd32(value), 1, 0, false, width, pad);
+}
+
+
+bool serialPrintInt(long value, byte width, char pad)
+{
+    // Also right for the most negative value
+    ulong magnitude = (value < 0) ? 0UL - (ulong)value : (ulong)value;
+
+    return _number(binToBcd32(magnitude), 1, 0, value < 0, width, pad);
+}
+
+
+bool serialPrintHex(ulong value, byte digits)
+{
+    return _number(value, digits, 0, false, 0, ' ');
+}
+
+
+bool serialPrintFixed(long value, byte decimals, byte width)
+{
+    ulong magnitude = (value < 0) ? 0UL - (ulong)value : (ulong)value;
+
+    return _number(binToBcd32(magnitude), 1, decimals, value < 0, width, ' ');
+}
+
+
+bool serialPrintString(const char* string)
+{
+    uint length = 0;
+
+    while (string[length] != '\0')
+        length++;
+
+    return _text(string, length);
+}
+
+
+bool serialPrintf(const char* format, ...)
+{
+    va_list args;
+    bool    result = true;
+
+    va_start(args, format);
+
+    while (result && *format != '\0')
+    {
+        const char* run = format;
+        byte width   = 0;
+        char pad     = ' ';
+        bool isLong  = false;
+
+        // The text up to the next conversion
+        if (*format != '%')
+        {
+            while (*format != '\0' && *format != '%')
+                format++;
+
+            result = _text(run, format - run);
+            continue;
+        }
+
+        if (*++format == '0')
+        {
+            pad = '0';
+            format++;
+        }
+
+        while (*format >= '0' && *format <= '9')
+            width = width * 10 + (*format++ - '0');
+
+        if (*format == 'l')
+        {
+            isLong = true;
+            format++;
+        }
+
+        switch (*format)
+        {
+            case 'd':
+            case 'i':
+                result = serialPrintInt(
+                    isLong ? va_arg(args, long) : va_arg(args, int),
+                    width, pad);
+                break;
+
+            case 'u':
+                result = serialPrintUInt(
+                    isLong ? va_arg(args, ulong) : va_arg(args, uint),
+                    width, pad);
+                break;
+
+            case 'x':
+            case 'X':
+                result = _number(
+                    isLong ? va_arg(args, ulong) : va_arg(args, uint),
+                    1, 0, false, width, pad);
+                break;
+
+            case 'c':
+            {
+                char data = (char)va_arg(args, int);
+                result = _text(&data, 1);
+                break;
+            }
+
+            case 's':
+                result = serialPrintString(va_arg(args, const char*));
+                break;
+
+            case '%':
+                result = _text(format, 1);
+                break;
+
+            // Incomplete conversion
+            case '\0':
+                continue;
+        }
+
+        format++;
+    }
+
+    va_end(args);
+    return result;
+}
+
+
+/**
+ * @brief Waits for the given free space
+ * in the tx buffer.
+ */
+static bool _reserve(uint length)
+{
+    register CircularBuffer* tx = &Serial._tx;
+
+    if (length > tx->size)
+        return false;
+
+    // Woken when the tx buffer is empty
+    while (tx->size - tx->count < length)
+        powerIdle();
+
+    _start = tx->w_pos;
+    return true;
+}
+
+
+/**
+ * @brief Writes a byte of the reserved field,
+ * not seen by the interrupt until committed.
+ */
+static void _putAt(uint offset, byte data)
+{
+    register CircularBuffer* tx = &Serial._tx;
+    uint index = _start + offset;
+
+    if (index >= tx->size)
+        index -= tx->size;
+
+    tx->buff[index] = data;
+}
+
+
+/**
+ * @brief Adds the reserved field
+ * to the tx buffer and sends it.
+ */
+static void _commit(uint length)
+{
+    SERIAL_LOCK_TX
+    (
+        cbWriteCommit(&Serial._tx, length);
+    );
+}
+
+
+/**
+ * @brief The number of significant nibbles
+ * of a 64 bits value, at least 1.
+ */
+static byte _nibbles(ulong low, ulong high)
+{
+    byte count = 1;
+
+    if (high != 0)
+    {
+        count += 8;
+        low = high;
+    }
+
+    while (low > 0x0F)
+    {
+        low >>= 4;
+        count++;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Writes some bytes, in parts
+ * as big as the tx buffer.
+ */
+static bool _text(const char* data, uint length)
+{
+    while (length > 0)
+    {
+        uint part = (length < Serial._tx.size) ? length : Serial._tx.size;
+        uint i;
+
+        // Closed port: nothing would ever be sent
+        if (part == 0 || !_reserve(part))
+            return false;
+
+        for (i = 0; i < part; i++)
+            _putAt(i, *data++);
+
+        _commit(part);
+        length -= part;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief
+ * Writes a number from its nibbles: packed BCD
+ * digits, or the value itself for hexadecimal.
+ * The field is filled from the right: digits
+ * (with the point), sign, padding.
+ */
+static bool _number(
+    unsigned long long nibbles,
+    byte               minDigits,
+    byte               decimals,
+    bool               negative,
+    byte               width,
+    char               pad)
+{
+    ulong low    = (ulong)nibbles;
+    ulong high   = (ulong)(nibbles >> 32);
+    byte  digits = _nibbles(low, high);
+    byte  extra  = (decimals != 0) + negative;
+    byte  i;
+    uint  length, offset;
+
+    // At least a digit before the point
+    if (digits <= decimals)
+        digits = decimals + 1;
+
+    if (digits < minDigits)
+        digits = minDigits;
+
+    // The zeros go between the sign and the digits
+    if (pad == '0' && digits + extra < width)
+        digits = width - extra;
+
+    length = digits + extra;
+    if (length < width)
+        length = width;
+
+    if (!_reserve(length))
+        return false;
+
+    for (offset = length, i = 0; i < digits; i++)
+    {
+        if (decimals != 0 && i == decimals)
+            _putAt(--offset, '.');
+
+        _putAt(--offset, _digits[low & 0x0F]);
+
+        // The nibbles after the 8th
+        if (i == 7)
+            low = high;
+        else
+            low >>= 4;
+    }
+
+    if (negative)
+        _putAt(--offset, '-');
+
+    while (offset > 0)
+        _putAt(--offset, ' ');
+
+    _commit(length);
+    return true;
+}
+
+
+#endif // !SERIAL_FORMAT_C
@@ -0,0 +1,80 @@
+#ifndef SERIAL_FORMAT_H
+#define SERIAL_FORMAT_H
+
+#include "utility.h"
+#include "serial.h"
+
+
+/**
+ * @brief
+ * Formatted output rendered in place in the free
+ * space of the Serial tx buffer: no intermediate
+ * buffer, and the decimal digits come from the
+ * division-free BCD conversions (bcd.h).
+ *
+ * Each call waits for enough free space, then writes
+ * its whole field at once. Only from the main loop.
+ * All return false, writing nothing, if the field is
+ * bigger than the tx buffer or the port is closed.
+ */
+
+
+/**
+ * @brief
+ * Writes an unsigned decimal number, right aligned
+ * in at least width characters.
+ *
+ * @param pad
+ *      ' ' or '0'.
+ */
+bool serialPrintUInt(ulong value, byte width, char pad);
+
+
+/**
+ * @brief
+ * Writes a signed decimal number, right aligned in
+ * at least width characters. With '0' padding the
+ * sign comes before the zeros.
+ */
+bool serialPrintInt(long value, byte width, char pad);
+
+
+/**
+ * @brief
+ * Writes an hexadecimal number (uppercase digits)
+ * with at least the given number of digits.
+ */
+bool serialPrintHex(ulong value, byte digits);
+
+
+/**
+ * @brief
+ * Writes a fixed point number: value is scaled by
+ * 10^decimals, e.g. 1234 with 2 decimals is "12.34"
+ * and -5 is "-0.05".
+ */
+bool serialPrintFixed(long value, byte decimals, byte width);
+
+
+/**
+ * @brief
+ * Writes a NULL terminated string.
+ */
+bool serialPrintString(const char* string);
+
+
+/**
+ * @brief
+ * A printf subset: %d %i %u %x %X %c %s %%, with
+ * the '0' flag, a width and the 'l' modifier for
+ * long arguments; %x and %X are both uppercase.
+ * Each conversion is written as soon as it's 
+ * rendered.
+ *
+ * @returns
+ *      False if a part didn't fit, see above.
+ */
+bool serialPrintf(const char* format, ...);
+
+
+#endif // !SERIAL_FORMAT_H
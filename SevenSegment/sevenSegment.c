@@ -2,7 +2,9 @@
 #define SEVEN_SEGMENT_C
 
 #include "sevenSegment.h"
+#include "memoryManager.h"
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @brief Allocates a SevenSegmentInfo structure
@@ -22,7 +24,9 @@ SevenSegmentInfo* createSevenSegmentInfo(
              volatile unsigned char* segmentsDirRegister)
 {
     SevenSegmentInfo* result = 
-        (SevenSegmentInfo*)malloc(sizeof(SevenSegmentInfo));
+        (SevenSegmentInfo*)memAlloc(sizeof(SevenSegmentInfo));
+    
+    if (result == NULL) return NULL;
     
     result->segmentsRegister    = segmentsRegister;
     result->segmentsDirRegister = segmentsDirRegister;
@@ -41,6 +45,16 @@ inline void sevenSegWrite(SevenSegmentInfo* segInfo, unsigned char value)
 {
     *(segInfo->segmentsRegister) = hexToSevenSeg(value);
 }
+
+
+/**
+ * @brief Turns the display's dot ON or OFF,
+ * without changing the other segments.
+ */
+inline void sevenSegDot(SevenSegmentInfo* segInfo, char state)
+{
+    SET_PORT(*(segInfo->segmentsRegister), SEG_DOT, state);
+}
     
 
 /**
@@ -59,7 +73,68 @@ unsigned char hexToSevenSeg(unsigned char value)
         0x46,0x21,0x06,0x0E
     };
 
-    return ~segValues[value & 0x0F];
+    // Leaving the dot (BIT7) off
+    return ~segValues[value & 0x0F] & 0x7F;
+}
+
+
+/**
+ * @brief The segments of the printable ASCII 
+ * characters, from SEG_FONT_FIRST (space) to 
+ * SEG_FONT_LAST (del). Stored in flash.
+ */
+const unsigned char sevenSegFont[SEG_FONT_LAST - SEG_FONT_FIRST + 1] =
+{
+    /* sp ! " # $ % & '  */ 0x00, 0x86, 0x22, 0x7E, 0x6D, 0xD2, 0x46, 0x20,
+    /* ( ) * + , - . /   */ 0x29, 0x0B, 0x21, 0x70, 0x10, 0x40, 0x80, 0x52,
+    /* 0 1 2 3 4 5 6 7   */ 0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,
+    /* 8 9 : ; < = > ?   */ 0x7F, 0x6F, 0x09, 0x0D, 0x61, 0x48, 0x43, 0xD3,
+    /* @ A B C D E F G   */ 0x5F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D,
+    /* H I J K L M N O   */ 0x76, 0x30, 0x1E, 0x75, 0x38, 0x15, 0x37, 0x3F,
+    /* P Q R S T U V W   */ 0x73, 0x6B, 0x33, 0x6D, 0x78, 0x3E, 0x3E, 0x2A,
+    /* X Y Z [ \ ] ^ _   */ 0x76, 0x6E, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08,
+    /* ` a b c d e f g   */ 0x02, 0x5F, 0x7C, 0x58, 0x5E, 0x7B, 0x71, 0x6F,
+    /* h i j k l m n o   */ 0x74, 0x10, 0x0C, 0x75, 0x30, 0x14, 0x54, 0x5C,
+    /* p q r s t u v w   */ 0x73, 0x67, 0x50, 0x6D, 0x78, 0x1C, 0x1C, 0x14,
+    /* x y z { | } ~ del */ 0x76, 0x6E, 0x5B, 0x46, 0x30, 0x70, 0x01, 0x00,
+};
+
+
+/**
+ * @brief Converts an ASCII character to the
+ * representation used by a seven segment display.
+ */
+inline unsigned char charToSevenSeg(char value)
+{
+    return (value >= SEG_FONT_FIRST && value <= SEG_FONT_LAST)
+        ? sevenSegFont[value - SEG_FONT_FIRST]
+        : 0;
+}
+
+
+/**
+ * @brief Encodes a string in the representation 
+ * used by seven segment displays.
+ */
+unsigned int textToSevenSeg(
+             const char* text, 
+             unsigned char* segments, 
+             unsigned int size)
+{
+    register unsigned int length = 0;
+    
+    for (; *text && length < size; text++)
+    {
+        // Dots are merged in the previous character
+        // when it doesn't have one already
+        if (*text == '.' && length > 0 && !(segments[length - 1] & SEG_DOT))
+            segments[length - 1] |= SEG_DOT;
+        
+        else
+            segments[length++] = charToSevenSeg(*text);
+    }
+    
+    return length;
 }
 
 
@@ -69,19 +144,41 @@ unsigned char hexToSevenSeg(unsigned char value)
  */
 inline unsigned int decToHex(register unsigned int num)
 {
-    unsigned int mig, cent, dec, uni;
-    // num = 1987
-    mig  = num / 1000; //   1
-    num  = num % 1000; // 987
+    // num = 1987 -> 0x1987
+    return (unsigned int)binToBcd16(num);
+}
 
-    cent = num / 100; //  9
-    num  = num % 100; // 87
+
+/**
+ * @brief Encodes a signed decimal number in the
+ * representation used by seven segment displays.
+ */
+bool decToSevenSeg(long value, unsigned char* segments, unsigned char digits)
+{
+    bool negative = value < 0;
+    
+    unsigned long long bcd = 
+        binToBcd32(negative ? -(unsigned long)value : (unsigned long)value);
+    
+    register unsigned char used = 
+        bcdDigits(bcd) + negative;
+    
+    if (used > digits)
+    {
+        memset(segments, SEG_MINUS, digits);
+        return false;
+    }
+    
+    // Blanking the leading zeros
+    memset(segments, 0, digits - used);
+    
+    if (negative)
+        segments[digits - used] = SEG_MINUS;
     
-    dec = num / 10;   // 8
-    uni = num % 10;   // 7
+    for (segments += digits; used > negative; used--, bcd >>= 4)
+        *--segments = hexToSevenSeg((unsigned char)bcd);
     
-    return 
-        (mig << 12)|(cent << 8)|(dec << 4)| uni ; // 0x1987
+    return true;
 }
     
     
@@ -1,6 +1,8 @@
 #ifndef SEVEN_SEGMENT_H
 #define SEVEN_SEGMENT_H
 
+#include "bcd.h"
+
 
 #ifndef SEG_DATA
 #define SEG_DATA 0xFF
@@ -16,6 +18,22 @@
 #endif // !SEG_DATA_OFF
 
 
+#ifndef SEG_DOT
+/**
+ * @brief The dot's segment.
+ */
+#define SEG_DOT 0x80
+#endif // !SEG_DOT
+
+
+#ifndef SEG_MINUS
+/**
+ * @brief The segments of a minus sign (g).
+ */
+#define SEG_MINUS 0x40
+#endif // !SEG_MINUS
+
+
 /**
  * @brief Holds informations about a 
  * sevent segment display.
@@ -43,7 +61,7 @@ typedef struct SevenSegmentInfo
 
 /**
  * @brief Allocates a SevenSegmentInfo structure
- * and returns a pointer to it.
+ * and returns a pointer to it, NULL if out of memory.
  *
  * @param segmentsRegister 
  *      The display's port used to control
@@ -62,13 +80,13 @@ SevenSegmentInfo* createSevenSegmentInfo(
 /**
  * @brief Writes a number to a seven segment display.
  */
-inline void sevenSegWrite(SevenSegmentInfo* segInfo, unsigned char value);
+void sevenSegWrite(SevenSegmentInfo* segInfo, unsigned char value);
 
 
 /**
  * @brief Turns the display's dot ON or OFF.
  */
-inline void sevenSegDot(SevenSegmentInfo* segInfo, char state);
+void sevenSegDot(SevenSegmentInfo* segInfo, char state);
  
 /**
  * @brief Converts an hexadecimal value to the
@@ -79,10 +97,85 @@ inline void sevenSegDot(SevenSegmentInfo* segInfo, char state);
 unsigned char hexToSevenSeg(unsigned char value);
 
 
+/**
+ * @brief The first and the last characters 
+ * of sevenSegFont.
+ */
+#define SEG_FONT_FIRST ' '
+#define SEG_FONT_LAST  0x7F
+
+
+/**
+ * @brief The segments of the printable ASCII 
+ * characters, from SEG_FONT_FIRST to SEG_FONT_LAST.
+ * Letters that can't be told apart from digits 
+ * are approximated (S and 5, O and 0...).
+ */
+extern const unsigned char sevenSegFont[SEG_FONT_LAST - SEG_FONT_FIRST + 1];
+
+
+/**
+ * @brief Converts an ASCII character to the
+ * representation used by a seven segment display.
+ *
+ * The characters outside the font are blank.
+ */
+unsigned char charToSevenSeg(char value);
+
+
+/**
+ * @brief Encodes a string in the representation 
+ * used by seven segment displays, a byte per 
+ * character. Dots are merged in the previous 
+ * character when possible.
+ *
+ * @param text
+ *      The NULL terminated string to encode.
+ *
+ * @param segments
+ *      The encoded characters.
+ *
+ * @param size
+ *      The size of segments.
+ *
+ * @returns
+ *      The number of encoded characters.
+ */
+unsigned int textToSevenSeg(
+             const char* text, 
+             unsigned char* segments, 
+             unsigned int size);
+
+
 /**
  * @brief Converts a decimal value to it's 
- * hexadecimal representation.
+ * hexadecimal representation (packed BCD).
+ *
+ * Only the last four digits are kept, 
+ * binToBcd16 keeps all of them.
  */
 unsigned int decToHex(register unsigned int value);
 
+
+/**
+ * @brief Encodes a signed decimal number in the
+ * representation used by seven segment displays,
+ * right aligned, with the leading zeros blanked 
+ * and a minus for the negative values.
+ *
+ * @param value 
+ *      The number to encode.
+ *
+ * @param segments 
+ *      The encoded digits, from the leftmost.
+ *
+ * @param digits
+ *      The number of digits of the display.
+ *
+ * @returns
+ *      False if the number doesn't fit, in that
+ *      case all the digits show a minus.
+ */
+bool decToSevenSeg(long value, unsigned char* segments, unsigned char digits);
+
 #endif // !SEVEN_SEGMENT_H
\ No newline at end of file
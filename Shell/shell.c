@@ -0,0 +1,212 @@
+#ifndef SHELL_C
+#define SHELL_C
+
+#include "shell.h"
+#include "serial.h"
+#include "serialFormat.h"
+
+
+/**
+ * @brief The line being received, with room
+ * for the string terminator.
+ */
+static char _line[SHELL_LINE_SIZE + 1];
+static uint _length = 0;
+
+/**
+ * @brief Set when a line doesn't fit: the
+ * rest of it is skipped.
+ */
+static bool _skipping = false;
+
+static ShellDispatcher _dispatcher = NULL;
+
+
+static ShellStatus _run(char* line, uint length);
+static bool        _isSpace(char c);
+
+
+void initShell(ShellDispatcher dispatcher)
+{
+    _dispatcher = dispatcher;
+    _length     = 0;
+    _skipping   = false;
+}
+
+
+ShellStatus shellPoll(void)
+{
+    ShellStatus status = SHELL_EMPTY;
+
+    // All the received lines: a burst of
+    // commands must not fill the rx buffer
+    while (Serial.readUntilAsync(
+               (byte*)_line, SHELL_LINE_SIZE, '\n', &_length))
+    {
+        // Otherwise the buffer is full
+        bool complete = (_length < SHELL_LINE_SIZE);
+
+        if (_skipping)
+        {
+            // The end of the line too long
+            _skipping = !complete;
+            _length   = 0;
+            continue;
+        }
+
+        if (!complete)
+        {
+            serialPrintString("line too long\r\n");
+
+            _skipping = true;
+            _length   = 0;
+            status    = SHELL_TOO_LONG;
+            continue;
+        }
+
+        status  = _run(_line, _length);
+        _length = 0;
+    }
+
+    return status;
+}
+
+
+ShellStatus shellUsage(const char* usage)
+{
+    serialPrintf("usage: %s\r\n", usage);
+    return SHELL_USAGE;
+}
+
+
+bool shellParseUInt(const char* text, ulong* value)
+{
+    ulong result = 0;
+    bool  hex    = (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'));
+
+    if (hex)
+        text += 2;
+
+    if (*text == '\0')
+        return false;
+
+    for (; *text != '\0'; text++)
+    {
+        char c = *text;
+        byte digit;
+
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+
+        else if (hex && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            digit = (c | 0x20) - 'a' + 10;
+
+        else
+            return false;
+
+        if (hex)
+        {
+            if (result > 0x0FFFFFFFUL)
+                return false;
+
+            result = (result << 4) | digit;
+        }
+        else
+        {
+            // result * 10 + digit, without overflow
+            if (result > 429496729UL ||
+                (result == 429496729UL && digit > 5))
+                return false;
+
+            result = (result << 3) + (result << 1) + digit;
+        }
+    }
+
+    *value = result;
+    return true;
+}
+
+
+bool shellParseInt(const char* text, long* value)
+{
+    ulong magnitude;
+    bool  negative = (*text == '-');
+
+    if (negative || *text == '+')
+        text++;
+
+    // Only decimal
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+        return false;
+
+    if (!shellParseUInt(text, &magnitude) ||
+        magnitude > (negative ? 0x80000000UL : 0x7FFFFFFFUL))
+        return false;
+
+    *value = negative ? (long)(0UL - magnitude) : (long)magnitude;
+    return true;
+}
+
+
+/**
+ * @brief Splits a line into words, in place,
+ * and runs its command.
+ */
+static ShellStatus _run(char* line, uint length)
+{
+    char* argv[SHELL_MAX_ARGS];
+    byte  argc = 0;
+    uint  i    = 0;
+    uint  end;
+    ShellStatus status;
+
+    if (length > 0 && line[length - 1] == '\r')
+        length--;
+
+    line[length] = '\0';
+
+    while (i < length)
+    {
+        while (i < length && _isSpace(line[i]))
+            i++;
+
+        if (i == length)
+            break;
+
+        if (argc == SHELL_MAX_ARGS)
+        {
+            serialPrintString("too many arguments\r\n");
+            return SHELL_TOO_MANY_ARGS;
+        }
+
+        argv[argc++] = &line[i];
+
+        while (i < length && !_isSpace(line[i]))
+            i++;
+
+        line[i++] = '\0';
+    }
+
+    if (argc == 0 || _dispatcher == NULL)
+        return SHELL_EMPTY;
+
+    end = strlen(argv[0]) - 1;
+
+    status = _dispatcher(
+        SHELL_HASH(argv[0][0], argv[0][end], end + 1),
+        argc, argv);
+
+    if (status == SHELL_UNKNOWN)
+        serialPrintf("unknown command: %s\r\n", argv[0]);
+
+    return status;
+}
+
+
+static bool _isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+
+#endif // !SHELL_C
@@ -0,0 +1,166 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <string.h>
+#include "utility.h"
+
+
+#ifndef SHELL_LINE_SIZE
+/**
+ * @brief The command lines must be shorter,
+ * terminator excluded: the longer ones are
+ * skipped.
+ */
+#define SHELL_LINE_SIZE 64
+#endif // !SHELL_LINE_SIZE
+
+
+#ifndef SHELL_MAX_ARGS
+/**
+ * @brief The maximum number of words of a
+ * command line, the command included.
+ */
+#define SHELL_MAX_ARGS 8
+#endif // !SHELL_MAX_ARGS
+
+
+/**
+ * @brief The outcome of a command line.
+ */
+typedef enum ShellStatus
+{
+    SHELL_DONE = 0x00,
+    SHELL_EMPTY,
+    SHELL_UNKNOWN,
+    SHELL_USAGE,
+    SHELL_TOO_LONG,
+    SHELL_TOO_MANY_ARGS
+} ShellStatus;
+
+
+/**
+ * @brief
+ * Runs a command. The arguments point into the
+ * line buffer, valid until the handler returns.
+ *
+ * @returns
+ *      False to print the command's usage.
+ */
+typedef bool (*ShellHandler)(byte argc, char** argv);
+
+
+/**
+ * @brief
+ * Finds and runs the command of a line, from
+ * the hash of its name: made by SHELL_DISPATCHER.
+ */
+typedef ShellStatus (*ShellDispatcher)(ulong hash, byte argc, char** argv);
+
+
+/**
+ * @brief
+ * The hash of a command name, from its first and
+ * last characters and its length: a constant for
+ * char literals, so that the commands are the
+ * cases of a switch. Different triples never
+ * have the same hash.
+ */
+#define SHELL_HASH(first, last, length)     \
+    (((ulong)(byte)(first) << 16) |         \
+     ((uint)(byte)(last) << 8)    |         \
+     (byte)(length))
+
+
+/**
+ * @brief
+ * Defines a dispatcher function for a list of commands,
+ * given as an X-macro of
+ *
+ *   COMMAND(name, first, last, handler, usage)
+ *
+ * where first and last are the first and the last
+ * characters of name, e.g.
+ *
+ *   #define MY_COMMANDS(COMMAND)                             \
+ *       COMMAND(led,   'l', 'd', ledCommand,   "led on|off") \
+ *       COMMAND(reset, 'r', 't', resetCommand, "reset")
+ *
+ *   SHELL_DISPATCHER(myDispatcher, MY_COMMANDS)
+ *
+ * The hashes are case labels: two commands with
+ * the same hash (same first and last characters
+ * and length) don't compile.
+ */
+#define SHELL_DISPATCHER(dispatcher, commands)                  \
+    static ShellStatus dispatcher(ulong hash, byte argc, char** argv) \
+    {                                                           \
+        switch (hash)                                           \
+        {                                                       \
+            commands(SHELL_CASE)                                \
+        }                                                       \
+        return SHELL_UNKNOWN;                                   \
+    }
+
+
+#define SHELL_CASE(name, first, last, handler, usage)           \
+    case SHELL_HASH(first, last, sizeof(#name) - 1):            \
+        if (strcmp(argv[0], #name) != 0)                        \
+            return SHELL_UNKNOWN;                               \
+        return handler(argc, argv)                              \
+            ? SHELL_DONE                                        \
+            : shellUsage(usage);
+
+
+/**
+ * @brief
+ * Starts reading the commands from Serial,
+ * which must be open.
+ */
+void initShell(ShellDispatcher dispatcher);
+
+
+/**
+ * @brief
+ * Runs all the command lines received so far,
+ * without blocking: called by the main loop.
+ * Lines end with '\n', a '\r' before it is
+ * ignored.
+ *
+ * @returns
+ *      The outcome of the last line run,
+ *      SHELL_EMPTY if none.
+ */
+ShellStatus shellPoll(void);
+
+
+/**
+ * @brief
+ * Prints the usage of a command,
+ * used by the dispatchers.
+ *
+ * @returns
+ *      SHELL_USAGE.
+ */
+ShellStatus shellUsage(const char* usage);
+
+
+/**
+ * @brief
+ * Parses an unsigned number, decimal
+ * or hexadecimal with 0x.
+ *
+ * @returns
+ *      False if the text isn't a number
+ *      or doesn't fit.
+ */
+bool shellParseUInt(const char* text, ulong* value);
+
+
+/**
+ * @brief
+ * Parses a signed decimal number.
+ */
+bool shellParseInt(const char* text, long* value);
+
+
+#endif // !SHELL_H
@@ -2,10 +2,12 @@
 #define TIMER_C
 
 
+#include <string.h>
 #include "timer.h"
 #include "utility.h"
 #include "linkedList.h"
-#include <stdlib.h>
+#include "power.h"
+#include "trace.h"
 
 
 /**
@@ -15,6 +17,33 @@
 Node* __timers = NULL;
 
 
+/**
+ * @brief The expired timers removed by the
+ * interrupt, linked by their next pointers,
+ * waiting to be freed.
+ */
+static Node* volatile _expired = NULL;
+
+
+#if TIMER_ACCOUNTING
+
+/**
+ * @brief The ticks since the last summary,
+ * and the ones that ran past the next tick.
+ */
+static uint _ticks    = 0;
+static uint _overruns = 0;
+
+static uint _lateness(void);
+static void _account(TimerStats* stats, uint late, uint run);
+static void _clearStats(TimerStats* stats);
+
+#endif // TIMER_ACCOUNTING
+
+
+static void _updatePower(void);
+
+
 /**
  * @brief Creates a timer.
  *
@@ -31,13 +60,19 @@ Node* __timers = NULL;
 TimerInfo* createTimerInfo(unsigned int interruptCalls, bool autoReset, void (*elapsed)(void))
 {
     TimerInfo* result = 
-        (TimerInfo*)malloc(sizeof(TimerInfo));
+        (TimerInfo*)memPoolAlloc(sizeof(TimerInfo));
+    
+    if (result == NULL) return NULL;
     
     result->interruptCalls = interruptCalls;
     result->autoReset      = autoReset;
     result->elapsed        = elapsed;
     result->_calls         = 0;
     
+#if TIMER_ACCOUNTING
+    _clearStats(&result->_stats);
+#endif // TIMER_ACCOUNTING
+    
     return result;
 }
 
@@ -57,22 +92,60 @@ void initTimer0(unsigned int ccr0Delay)
     TA0CTL &= ~TAIFG;  // Clear TAIFG flag
     TA0CTL |=  TAIE;    // Enable TAIFG Interrupt
     
+#if TIMER_ACCOUNTING
+    // Measuring the callbacks
+    initCycleCounter();
+#endif // TIMER_ACCOUNTING
+    
     // Initializing timers list
     if (__timers == NULL)
         __timers = createNode(NULL, NULL, NULL);
 }
 
 
+/**
+ * @brief Starts the Timer A2 cycle counter.
+ */
+void initCycleCounter(void)
+{
+    TA2CTL = 
+        TASSEL_2 + // Select TAR Clock source = smclk
+        MC_2     + // Count mode continuous
+        TACLR;
+}
+
+
 /**
  * @brief Add a TimerInfo struct to the managed
  * timers list.
- * @returns The new timer.
+ * @returns False if out of memory or
+ * before initTimer0.
  */
-inline void addManagedTimer(TimerInfo* timer)
+inline bool addManagedTimer(TimerInfo* timer)
 {
-    // Adding the timer to the
-    // managed ones.
-    llAdd(__timers, timer);
+    Node* node;
+    
+    // Reusing the expired timers' nodes
+    collectManagedTimers();
+    
+    // Not initialized (initTimer0)
+    if (__timers == NULL)
+        return false;
+    
+    node = createNode(timer, NULL, NULL);
+    
+    if (node == NULL)
+        return false;
+    
+    // The interrupt can unlink the last
+    // timer while it's being found
+    ATOMIC
+    (
+        llLinkTwo(llGetLast(__timers), node);
+    );
+    
+    _updatePower();
+    return true;
 }
 
 
@@ -81,7 +154,18 @@ inline void addManagedTimer(TimerInfo* timer)
  */
 inline void clearManagedTimers(void)
 {
-    llClear(&__timers, true);
+    Node* timers;
+    
+    collectManagedTimers();
+    
+    ATOMIC
+    (
+        timers   = __timers;
+        __timers = NULL;
+    );
+    
+    llClear(&timers, true);
+    _updatePower();
     
     // Re-initializing timers list
     __timers = createNode(NULL, NULL, NULL);
@@ -96,52 +180,279 @@ inline void removeManagedTimer(TimerInfo* timer, bool freeContent)
     if (__timers == NULL) return;
   
     register Node* current;
-    for (
-         current = __timers->next;
-         current != NULL;
-         current = current->next)
-    {
-        if (current->content == timer)
+    Node* found = NULL;
+    
+    collectManagedTimers();
+    
+    // The interrupt can unlink the 
+    // expired timers while searching
+    ATOMIC
+    (
+        for (
+             current = __timers->next;
+             current != NULL;
+             current = current->next)
         {
-            llRemove(&__timers, current, freeContent);
-            return;
+            if (current->content == timer)
+            {
+                llUnlink(&__timers, current);
+                found = current;
+                break;
+            }
         }
+    );
+    
+    // Otherwise already expired,
+    // freed by the next collection
+    if (found == NULL) return;
+    
+    _updatePower();
+    
+    if (freeContent)
+        memFree(timer);
+    
+    memFree(found);
+}
+
+
+/**
+ * @brief Frees the expired timers without auto reset.
+ */
+void collectManagedTimers(void)
+{
+    register Node* current;
+    Node* next;
+    
+    ATOMIC
+    (
+        current  = _expired;
+        _expired = NULL;
+    );
+    
+    for (; current != NULL; current = next)
+    {
+        next = current->next;
+        
+        memFree(current->content);
+        memFree(current);
     }
 }
 
+/**
+ * @brief Copies the stats of a timer.
+ */
+void timerGetStats(TimerInfo* timer, TimerStats* stats)
+{
+#if TIMER_ACCOUNTING
+    ATOMIC
+    (
+        *stats = timer->_stats;
+    );
+#else
+    // Nothing measured
+    memset(stats, 0, sizeof(TimerStats));
+#endif // TIMER_ACCOUNTING
+}
+
+
+/**
+ * @brief Summarizes the ticks since the last summary.
+ */
+void timerSummary(TimerSummary* summary, bool reset)
+{
+#if TIMER_ACCOUNTING
+    register Node* current;
+    ulong busiest = 0;
+    ulong latest  = 0;
+    
+    summary->callbackCycles = 0;
+    summary->misses         = 0;
+    summary->busiest        = NULL;
+    summary->latest         = NULL;
+    
+    // The interrupt updates the stats
+    // and unlinks the expired timers
+    ATOMIC
+    (
+        summary->ticks    = _ticks;
+        summary->overruns = _overruns;
+        
+        for (
+             current = (__timers != NULL) ? __timers->next : NULL;
+             current != NULL;
+             current = current->next)
+        {
+            TimerInfo*  timer = LL_GET_TIMER_INFO(current);
+            TimerStats* stats = &timer->_stats;
+            
+            summary->callbackCycles += stats->totalRun;
+            summary->misses         += stats->misses;
+            
+            if (stats->totalRun > busiest)
+            {
+                busiest = stats->totalRun;
+                summary->busiest = timer;
+            }
+            
+            if (stats->lateness > latest)
+            {
+                latest = stats->lateness;
+                summary->latest = timer;
+            }
+            
+            if (reset)
+                _clearStats(stats);
+        }
+        
+        if (reset)
+            _ticks = _overruns = 0;
+    );
+#else
+    // Nothing counted: busiest and latest NULL
+    memset(summary, 0, sizeof(TimerSummary));
+#endif // TIMER_ACCOUNTING
+}
+
+
 /**
  * @brief Interrupt called at each tick of the
  * hardware timer (timer 0). Checks the timers in the
  * timers linked list, and manages their callbacks.
+ * The CPU is woken if a callback posted work.
  */
+#pragma vector = TIMER0_A1_VECTOR
 __interrupt void __checkTimersCallback()
 {
+    TRACE_ISR_ENTER(TRACE_TIMER);
+    
     // Re-enabling the interrupt
     TA0CTL &= ~TAIFG;
     
+#if TIMER_ACCOUNTING
+    _ticks++;
+#endif // TIMER_ACCOUNTING
+    
+    if (__timers == NULL)
+    {
+        TRACE_ISR_EXIT(TRACE_TIMER);
+        return;
+    }
+    
     register Node* current;
+    Node* next;
     for (
          current = __timers->next;
          current != NULL; 
-         current = current->next)
+         current = next)
     {
         // Getting the timer
         TimerInfo* timer = LL_GET_TIMER_INFO(current);
+        next = current->next;
         
         // If the delay is reached
         if ((timer->_calls)++ == timer->interruptCalls)
         {
+#if TIMER_ACCOUNTING
+            uint late  = _lateness();
+            uint start = CYCLE_COUNTER();
+#endif // TIMER_ACCOUNTING
+            
             // Calling the callback
+            TRACE_CALLBACK_BEGIN(TRACE_TIMER_CALLBACK);
             RAISE_EVENT(timer->elapsed);
+            TRACE_CALLBACK_END(TRACE_TIMER_CALLBACK);
             
-            // Resetting the timer or deleting it
+#if TIMER_ACCOUNTING
+            _account(&timer->_stats, late, CYCLE_COUNTER() - start);
+#endif // TIMER_ACCOUNTING
+            
+            // Resetting the timer or moving it
+            // to the ones to free
             if (timer->autoReset)
                 timer->_calls = 0;
             
             else
-                llRemove(&__timers, current, true);
+            {
+                llUnlink(&__timers, current);
+                
+                current->next = _expired;
+                _expired = current;
+                
+                _updatePower();
+            }
         }   
     }
+    
+#if TIMER_ACCOUNTING
+    // The next tick is already late
+    if (TA0CTL & TAIFG)
+        _overruns++;
+#endif // TIMER_ACCOUNTING
+    
+    TRACE_ISR_EXIT(TRACE_TIMER);
+    POWER_WAKE_ON_EXIT();
+}
+
+
+#if TIMER_ACCOUNTING
+
+/**
+ * @brief The cycles since the tick: the timer 
+ * counts up from 0 to TA0CCR0 and sets TAIFG 
+ * again at the next tick.
+ */
+static uint _lateness(void)
+{
+    uint late = TA0R;
+    
+    if (TA0CTL & TAIFG)
+        late += TA0CCR0 + 1;
+    
+    return late;
+}
+
+
+/**
+ * @brief Adds a callback run to a timer's stats.
+ */
+static void _account(TimerStats* stats, uint late, uint run)
+{
+    stats->runs++;
+    stats->totalRun += run;
+    stats->lateness += late;
+    
+    if (run > stats->maxRun)
+        stats->maxRun = run;
+    
+    // Started after the next tick
+    if (late > TA0CCR0)
+        stats->misses++;
+}
+
+
+static void _clearStats(TimerStats* stats)
+{
+    stats->runs     = 0;
+    stats->maxRun   = 0;
+    stats->totalRun = 0;
+    stats->misses   = 0;
+    stats->lateness = 0;
+}
+
+#endif // TIMER_ACCOUNTING
+
+
+/**
+ * @brief The SMCLK must run while there 
+ * are managed timers.
+ */
+static void _updatePower(void)
+{
+    if (__timers != NULL && __timers->next != NULL)
+        powerRequire(POWER_TIMER, POWER_LPM0);
+    
+    else
+        powerRelease(POWER_TIMER);
 }
 
 #endif // !TIMER_C
\ No newline at end of file
@@ -16,6 +16,76 @@
 #endif // !TIMER0_MS
 
 
+#ifndef TIMER_ACCOUNTING
+/**
+ * @brief 
+ * Measures the callbacks of the managed timers:
+ * run time, lateness and deadline misses (see 
+ * TimerStats). The Timer A2 cycle counter is 
+ * started by initTimer0.
+ *
+ * The timers no longer fit the 8 bytes blocks:
+ * the 16 bytes pool (MEMORY_POOL1_BLOCKS) must 
+ * hold them.
+ */
+#define TIMER_ACCOUNTING 0
+#endif // !TIMER_ACCOUNTING
+
+
+/**
+ * @brief 
+ * The callback runs of a timer, in SMCLK cycles.
+ *
+ * A callback is due at the tick (TAIFG): its 
+ * lateness is the time from the tick to the 
+ * start of the callback, spent by the interrupt 
+ * latency and by the callbacks before it.
+ * Starting after the next tick is a deadline miss.
+ */
+typedef struct TimerStats
+{
+    uint  runs;
+    uint  maxRun;
+    ulong totalRun;
+    
+    uint  misses;
+    ulong lateness;
+    
+} TimerStats;
+
+
+/**
+ * @brief 
+ * The timers tick since the last summary.
+ */
+typedef struct TimerSummary
+{
+    uint  ticks;
+    
+    /**
+     * @brief The ticks whose callbacks ran past
+     * the next tick, which was delayed.
+     */
+    uint  overruns;
+    
+    /**
+     * @brief The cycles spent by all the callbacks.
+     */
+    ulong callbackCycles;
+    
+    /**
+     * @brief The timer whose callbacks took the 
+     * most cycles and the one with the most lateness,
+     * NULL if no callback ran.
+     */
+    struct TimerInfo* busiest;
+    struct TimerInfo* latest;
+    
+    uint  misses;
+    
+} TimerSummary;
+
+
 /**
  * @brief Represents a timer.
  */
@@ -35,7 +105,8 @@ typedef struct TimerInfo
      
     /**
      * A callback called every time the delay
-     * is elapsed.
+     * is elapsed, from the interrupt.
+     * POWER_POST_WORK wakes the main loop.
      */
     void (*elapsed)(void);
     
@@ -44,11 +115,16 @@ typedef struct TimerInfo
      */
     unsigned int _calls;
     
+#if TIMER_ACCOUNTING
+    TimerStats _stats;
+#endif // TIMER_ACCOUNTING
+    
 } TimerInfo;
 
 
 /**
- * @brief Creates a timer.
+ * @brief Creates a timer from the memory pools,
+ * returns NULL if out of memory.
  *
  * @param interval 
  *      The number of interrupt calls to wait before
@@ -69,8 +145,10 @@ TimerInfo* createTimerInfo(
 /**
  * @brief Add a TimerInfo struct to the managed
  * timers list.
+ * @returns False if out of memory or
+ * before initTimer0.
  */
-void addManagedTimer(TimerInfo* timer);
+bool addManagedTimer(TimerInfo* timer);
 
 
 /**
@@ -81,10 +159,41 @@ void clearManagedTimers(void);
 
 /**
  * @brief Removes a timer from the managed ones.
+ * Must not be called from a timer's callback.
  */
 void removeManagedTimer(TimerInfo* timer, bool freeContent);
 
 
+/**
+ * @brief Frees the expired timers without auto reset.
+ * The interrupt only unlinks them, since it must not
+ * free memory: called by the other managed timers 
+ * functions, or by the main loop.
+ */
+void collectManagedTimers(void);
+
+
+/**
+ * @brief Copies the stats of a timer.
+ * All zero without TIMER_ACCOUNTING.
+ */
+void timerGetStats(TimerInfo* timer, TimerStats* stats);
+
+
+/**
+ * @brief 
+ * Summarizes the ticks and the stats of all the 
+ * managed timers since the last summary, meant 
+ * to be called periodically by the main loop.
+ * All zero without TIMER_ACCOUNTING.
+ *
+ * @param reset
+ *      Clears the stats, so that the next
+ *      summary starts a new period.
+ */
+void timerSummary(TimerSummary* summary, bool reset);
+
+
 /**
  * @brief Returns a TimerInfo pointer 
  * from the content of a Node*
@@ -99,4 +208,19 @@ void removeManagedTimer(TimerInfo* timer, bool freeContent);
 void initTimer0(unsigned int ccr0Delay);
 
 
+/**
+ * @brief Starts the Timer A2 counting SMCLK cycles
+ * in continuous mode, without interrupts.
+ * The difference of two CYCLE_COUNTER readings 
+ * is the elapsed cycles, modulo 65536.
+ */
+void initCycleCounter(void);
+
+
+/**
+ * @brief Reads the Timer A2 cycle counter.
+ */
+#define CYCLE_COUNTER() (TA2R)
+
+
 #endif // !TIMER_H
\ No newline at end of file
@@ -0,0 +1,181 @@
+#ifndef TRACE_C
+#define TRACE_C
+
+#include "trace.h"
+#include "serial.h"
+
+
+#if TRACE_ENABLED
+
+
+/**
+ * @brief The records ring: written by the
+ * interrupts at _head, sent from _tail.
+ */
+static TraceRecord   _records[TRACE_RECORDS];
+static volatile uint _head = 0;
+static volatile uint _tail = 0;
+
+/**
+ * @brief The byte of the record at _tail
+ * to send next (TRACE_SYNC first).
+ */
+static byte _sent = 0;
+
+static volatile uint _dropped = 0;
+
+static TraceStats _stats[TRACE_HANDLERS];
+
+/**
+ * @brief The entry time of each handler.
+ */
+static uint _entered[TRACE_HANDLERS];
+
+
+#define TRACE_MASK (TRACE_RECORDS - 1)
+
+
+static void _record(byte tag, uint time);
+
+
+void initTrace(void)
+{
+    initCycleCounter();
+
+    ATOMIC
+    (
+        _head    = 0;
+        _tail    = 0;
+        _sent    = 0;
+        _dropped = 0;
+    );
+
+    traceResetStats();
+}
+
+
+void traceEnter(TraceId id)
+{
+    uint time = CYCLE_COUNTER();
+
+    _entered[id] = time;
+
+    if (TRACE_RECORDED & (1 << id))
+        _record(id, time);
+}
+
+
+void traceExit(TraceId id)
+{
+    uint time     = CYCLE_COUNTER();
+    uint duration = time - _entered[id];
+    uint scaled   = duration >> TRACE_BUCKET_SHIFT;
+    byte bucket   = 0;
+
+    register TraceStats* stats = &_stats[id];
+
+    stats->runs++;
+
+    if (duration < stats->min) stats->min = duration;
+    if (duration > stats->max) stats->max = duration;
+
+    // The bucket of the highest bit
+    while (scaled != 0 && bucket < TRACE_BUCKETS - 1)
+    {
+        scaled >>= 1;
+        bucket++;
+    }
+
+    stats->histogram[bucket]++;
+
+    if (TRACE_RECORDED & (1 << id))
+        _record(id + TRACE_EXIT, time);
+}
+
+
+bool traceDrain(void)
+{
+    while (_tail != _head)
+    {
+        TraceRecord* record = &_records[_tail];
+        byte data;
+
+        switch (_sent)
+        {
+            case 0:  data = TRACE_SYNC;          break;
+            case 1:  data = record->tag;         break;
+            case 2:  data = (byte)record->time;  break;
+            default: data = record->time >> 8;   break;
+        }
+
+        if (!Serial.writeCharAsync(data))
+            return false;
+
+        if (++_sent == 4)
+        {
+            _sent = 0;
+            _tail = (_tail + 1) & TRACE_MASK;
+        }
+    }
+
+    return true;
+}
+
+
+void traceGetStats(TraceId id, TraceStats* stats)
+{
+    ATOMIC
+    (
+        *stats = _stats[id];
+    );
+}
+
+
+void traceResetStats(void)
+{
+    register byte id, bucket;
+
+    ATOMIC
+    (
+        for (id = 0; id < TRACE_HANDLERS; id++)
+        {
+            _stats[id].runs = 0;
+            _stats[id].min  = (uint)~0;
+            _stats[id].max  = 0;
+
+            for (bucket = 0; bucket < TRACE_BUCKETS; bucket++)
+                _stats[id].histogram[bucket] = 0;
+        }
+    );
+}
+
+
+uint traceDropped(void)
+{
+    return _dropped;
+}
+
+
+/**
+ * @brief Adds a record, unless the ring is full.
+ */
+static void _record(byte tag, uint time)
+{
+    uint next = (_head + 1) & TRACE_MASK;
+
+    if (next == _tail)
+    {
+        _dropped++;
+        return;
+    }
+
+    _records[_head].tag  = tag;
+    _records[_head].time = time;
+
+    _head = next;
+}
+
+
+#endif // TRACE_ENABLED
+
+#endif // !TRACE_C
@@ -0,0 +1,217 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string.h>
+#include "utility.h"
+#include "timer.h"
+
+
+#ifndef TRACE_ENABLED
+/**
+ * @brief Compiles the instrumentation of the
+ * interrupts: with 0 the TRACE_ macros and the
+ * functions are empty, the module takes no memory.
+ */
+#define TRACE_ENABLED 0
+#endif // !TRACE_ENABLED
+
+
+#ifndef TRACE_RECORDS
+/**
+ * @brief The size of the records ring,
+ * a power of 2.
+ */
+#define TRACE_RECORDS 64
+#endif // !TRACE_RECORDS
+
+
+/**
+ * @brief The histogram of the run times: bucket n
+ * counts the runs shorter than
+ * (1 << (TRACE_BUCKET_SHIFT + n)) cycles,
+ * the last one all the longer runs.
+ */
+#define TRACE_BUCKETS      8
+#define TRACE_BUCKET_SHIFT 5
+
+
+/**
+ * @brief The first byte of each record sent
+ * by traceDrain, to find the records in the
+ * serial stream.
+ */
+#define TRACE_SYNC 0xA5
+
+
+/**
+ * @brief The traced interrupts and callbacks.
+ */
+typedef enum TraceId
+{
+    TRACE_SERIAL = 0x00,
+    TRACE_TIMER,
+    TRACE_TIMER_CALLBACK,
+    TRACE_ADC12,
+    TRACE_I2C,
+    TRACE_DMA,
+    TRACE_DISPLAY,
+    TRACE_DEBOUNCER,
+    TRACE_PORT_EDGE,
+    TRACE_MODBUS,
+    TRACE_HANDLERS
+} TraceId;
+
+
+#ifndef TRACE_RECORDED
+/**
+ * @brief The handlers whose entries and exits are
+ * recorded, a bit per TraceId; the stats are kept
+ * for all of them. The serial interrupt is left out:
+ * sending its records would trace more of it.
+ */
+#define TRACE_RECORDED ((uint)~(1 << TRACE_SERIAL))
+#endif // !TRACE_RECORDED
+
+
+/**
+ * @brief Added to the id of a record
+ * written at the exit.
+ */
+#define TRACE_EXIT 0x80
+
+
+/**
+ * @brief
+ * A timestamped entry or exit, sent as
+ * TRACE_SYNC, tag, time low, time high.
+ */
+typedef struct TraceRecord
+{
+    /**
+     * @brief The TraceId, plus TRACE_EXIT
+     * for an exit.
+     */
+    byte tag;
+
+    /**
+     * @brief The cycle counter (CYCLE_COUNTER).
+     */
+    uint time;
+
+} TraceRecord;
+
+
+/**
+ * @brief The run times of a handler, in cycles.
+ */
+typedef struct TraceStats
+{
+    uint runs;
+    uint min;
+    uint max;
+    uint histogram[TRACE_BUCKETS];
+
+} TraceStats;
+
+
+#if TRACE_ENABLED
+
+#define TRACE_ISR_ENTER(id)      traceEnter(id)
+#define TRACE_ISR_EXIT(id)       traceExit(id)
+#define TRACE_CALLBACK_BEGIN(id) traceEnter(id)
+#define TRACE_CALLBACK_END(id)   traceExit(id)
+
+#else
+
+#define TRACE_ISR_ENTER(id)      ((void)0)
+#define TRACE_ISR_EXIT(id)       ((void)0)
+#define TRACE_CALLBACK_BEGIN(id) ((void)0)
+#define TRACE_CALLBACK_END(id)   ((void)0)
+
+#endif // TRACE_ENABLED
+
+
+#if TRACE_ENABLED
+
+/**
+ * @brief
+ * Starts the cycle counter (Timer A2)
+ * and clears the records and the stats.
+ */
+void initTrace(void);
+
+
+/**
+ * @brief
+ * Records the entry of a handler.
+ * Only called by the interrupts (through
+ * the TRACE_ macros), which don't nest.
+ */
+void traceEnter(TraceId id);
+
+
+/**
+ * @brief
+ * Records the exit of a handler and
+ * adds its run time to its stats.
+ */
+void traceExit(TraceId id);
+
+
+/**
+ * @brief
+ * Sends the records over Serial until its tx
+ * buffer is full, without blocking: called
+ * by the main loop.
+ *
+ * @returns
+ *      True if all the records were sent.
+ */
+bool traceDrain(void);
+
+
+/**
+ * @brief
+ * Copies the stats of a handler.
+ */
+void traceGetStats(TraceId id, TraceStats* stats);
+
+
+/**
+ * @brief
+ * Clears the stats of all the handlers.
+ */
+void traceResetStats(void);
+
+
+/**
+ * @brief
+ * The records lost because the
+ * ring was full.
+ */
+uint traceDropped(void);
+
+#else
+
+/*
+ * Without the instrumentation the functions
+ * are empty: nothing recorded, nothing to send.
+ */
+
+static inline void initTrace(void) { }
+
+static inline bool traceDrain(void) { return true; }
+
+static inline void traceGetStats(TraceId id, TraceStats* stats)
+{
+    memset(stats, 0, sizeof(TraceStats));
+}
+
+static inline void traceResetStats(void) { }
+
+static inline uint traceDropped(void) { return 0; }
+
+#endif // TRACE_ENABLED
+
+
+#endif // !TRACE_H